@@ -0,0 +1,276 @@
+#include "bench_harness.hpp"
+#include "stencil_kernels.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace bench {
+
+    namespace {
+        /// Batches timed at least, budget permitting
+        const int MIN_BATCHES = 3;
+
+        /// Batches per time budget
+        const int BATCHES_PER_BUDGET = 10;
+
+        double to_double(const std::string& key, const std::string& value) {
+            std::size_t used = 0;
+            double v = 0.0;
+            try {
+                v = std::stod(value, &used);
+            } catch (const std::exception&) {
+                used = 0;
+            }
+            if (used == 0 || used != value.size() || v < 0.0) {
+                throw std::invalid_argument(key + ": expected a positive number, got '" + value + "'");
+            }
+            return v;
+        }
+
+        /// Number following `"field":` in a JSON line, false if there is none
+        bool find_number(const std::string& line, const std::string& field, double& value) {
+            std::size_t at = line.find("\"" + field + "\":");
+            if (at == std::string::npos) {
+                return false;
+            }
+            const char* start = line.c_str() + at + field.size() + 3;
+            char* end = nullptr;
+            value = std::strtod(start, &end);
+            return end != start;
+        }
+
+        /// String following `"field":` in a JSON line, without escapes
+        bool find_string(const std::string& line, const std::string& field, std::string& value) {
+            std::size_t at = line.find("\"" + field + "\":\"");
+            if (at == std::string::npos) {
+                return false;
+            }
+            std::size_t start = at + field.size() + 4;
+            std::size_t end = line.find('"', start);
+            if (end == std::string::npos) {
+                return false;
+            }
+            value = line.substr(start, end - start);
+            return true;
+        }
+    }
+
+    Options parse_options(const std::vector<std::string>& args) {
+        Options options;
+
+        for (std::size_t i = 0; i < args.size(); i++) {
+            const std::string& arg = args[i];
+            if (arg.compare(0, 2, "--") != 0) {
+                throw std::invalid_argument("unexpected argument '" + arg + "'");
+            }
+
+            std::string key = arg.substr(2);
+            std::string value;
+            std::size_t eq = key.find('=');
+            if (eq != std::string::npos) {
+                value = key.substr(eq + 1);
+                key = key.substr(0, eq);
+            } else if (i + 1 < args.size()) {
+                value = args[++i];
+            } else {
+                throw std::invalid_argument("missing value for --" + key);
+            }
+
+            if (key == "min-time") {
+                options.min_time = to_double(key, value);
+            } else if (key == "max-n") {
+                options.max_n = static_cast<int>(to_double(key, value));
+            } else if (key == "filter") {
+                options.filter = value;
+            } else if (key == "output") {
+                options.output = value;
+            } else if (key == "baseline") {
+                options.baseline = value;
+            } else if (key == "max-regression") {
+                options.max_regression = to_double(key, value);
+            } else {
+                throw std::invalid_argument("unknown option --" + key);
+            }
+        }
+
+        return options;
+    }
+
+    std::string usage(const std::string& program) {
+        return
+            "Usage: " + program + " [--key value | --key=value]...\n"
+            "\n"
+            "  --min-time        seconds spent timing each benchmark (0.5)\n"
+            "  --max-n           skip larger sizes, 0 for none (0)\n"
+            "  --filter          run the names containing this text only\n"
+            "  --output          JSON report file (stdout)\n"
+            "  --baseline        JSON report of an earlier run to compare with\n"
+            "  --max-regression  exit with 1 when a benchmark is slower than its\n"
+            "                    baseline by more than this fraction, e.g. 0.1\n";
+    }
+
+    Harness::Harness(const std::string& suite, const Options& options)
+        : suite_(suite)
+        , options_(options) {
+        if (!options_.baseline.empty()) {
+            load_baseline(options_.baseline);
+        }
+    }
+
+    std::string Harness::key(const std::string& name, int n) {
+        return name + "/" + std::to_string(n);
+    }
+
+    void Harness::load_baseline(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("cannot read baseline '" + path + "'");
+        }
+
+        // Reports hold one result per line
+        std::string line;
+        while (std::getline(in, line)) {
+            std::string name;
+            double n = 0.0;
+            double ns = 0.0;
+            if (find_string(line, "name", name) && find_number(line, "n", n) && find_number(line, "ns_per_cell", ns)) {
+                baseline_[key(name, static_cast<int>(n))] = ns;
+            }
+        }
+    }
+
+    bool Harness::wants(const std::string& name, int n) const {
+        if (options_.max_n > 0 && n > options_.max_n) {
+            return false;
+        }
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    void Harness::run(
+        const std::string& name
+        , int n
+        , long long cells
+        , const Model& model
+        , const std::function<int()>& op
+    ) {
+        using clock = std::chrono::steady_clock;
+
+        long long units = 0;
+        auto time_ops = [&](long long count) {
+            auto start = clock::now();
+            for (long long k = 0; k < count; k++) {
+                units += op();
+            }
+            return std::chrono::duration<double>(clock::now() - start).count();
+        };
+
+        Result result;
+        result.name = name;
+        result.n = n;
+        result.cells = cells;
+
+        // The warm-up builds the caches, such as factors, and is not a sample
+        double warm_up = time_ops(1);
+        units = 0;
+
+        bool slow = warm_up >= options_.min_time;
+        double batch_time = options_.min_time / BATCHES_PER_BUDGET;
+        long long batch = std::max(1LL, static_cast<long long>(batch_time / std::max(warm_up, 1e-9)));
+        std::vector<double> samples;
+        double spent = 0.0;
+        while (spent < options_.min_time || static_cast<int>(samples.size()) < (slow ? 1 : MIN_BATCHES)) {
+            double t = time_ops(batch);
+            samples.push_back(t / batch);
+            spent += t;
+            result.ops += batch;
+        }
+
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        result.seconds = samples[samples.size() / 2];
+        result.units = static_cast<double>(units) / result.ops;
+
+        double points = static_cast<double>(cells);
+        result.ns_per_cell = result.seconds / points * 1e9;
+        result.gflops = (model.flops + model.unit_flops * result.units) * points / result.seconds * 1e-9;
+        result.gbytes_per_s = (model.bytes + model.unit_bytes * result.units) * points / result.seconds * 1e-9;
+
+        auto base = baseline_.find(key(name, n));
+        if (base != baseline_.end()) {
+            result.baseline = base->second;
+        }
+
+        std::fprintf(stderr, "%-28s n=%-8d %12.3f ns/cell %8.2f GFLOP/s %8.2f GB/s\n"
+            , name.c_str(), n, result.ns_per_cell, result.gflops, result.gbytes_per_s);
+        results_.push_back(result);
+    }
+
+    void Harness::skip(const std::string& name, int n, const std::string& reason) {
+        std::fprintf(stderr, "%-28s n=%-8d skipped: %s\n", name.c_str(), n, reason.c_str());
+    }
+
+    int Harness::finish() {
+        std::ostringstream report;
+        report << "{\"suite\":\"" << suite_ << "\""
+               << ",\"simd\":\"" << ensiie::to_string(ensiie::detect_simd_level()) << "\""
+               << ",\"hardware_threads\":" << std::thread::hardware_concurrency()
+               << ",\"min_time\":" << options_.min_time
+               << ",\"results\":[\n";
+        for (std::size_t k = 0; k < results_.size(); k++) {
+            const Result& r = results_[k];
+            report << "{\"name\":\"" << r.name << "\""
+                   << ",\"n\":" << r.n
+                   << ",\"cells\":" << r.cells
+                   << ",\"ops\":" << r.ops
+                   << ",\"iterations\":" << r.units
+                   << ",\"seconds\":" << r.seconds
+                   << ",\"ns_per_cell\":" << r.ns_per_cell
+                   << ",\"gflops\":" << r.gflops
+                   << ",\"gbytes_per_s\":" << r.gbytes_per_s;
+            if (r.baseline > 0.0) {
+                report << ",\"baseline_ns_per_cell\":" << r.baseline
+                       << ",\"speedup\":" << r.baseline / r.ns_per_cell;
+            }
+            report << "}" << (k + 1 < results_.size() ? "," : "") << "\n";
+        }
+        report << "]}\n";
+
+        if (options_.output.empty()) {
+            std::cout << report.str() << std::flush;
+        } else {
+            std::ofstream file(options_.output);
+            if (!file || !(file << report.str())) {
+                throw std::runtime_error("cannot write '" + options_.output + "'");
+            }
+        }
+
+        if (options_.baseline.empty()) {
+            return 0;
+        }
+
+        int regressions = 0;
+        std::fprintf(stderr, "\n%-28s %-10s %12s %12s %8s\n", "benchmark", "n", "ns/cell", "baseline", "speedup");
+        for (const Result& r : results_) {
+            if (r.baseline <= 0.0) {
+                std::fprintf(stderr, "%-28s %-10d %12.3f %12s %8s\n", r.name.c_str(), r.n, r.ns_per_cell, "-", "new");
+                continue;
+            }
+            bool regressed = options_.max_regression > 0.0
+                          && r.ns_per_cell > r.baseline * (1.0 + options_.max_regression);
+            regressions += regressed ? 1 : 0;
+            std::fprintf(stderr, "%-28s %-10d %12.3f %12.3f %7.2fx%s\n", r.name.c_str(), r.n, r.ns_per_cell
+                , r.baseline, r.baseline / r.ns_per_cell, regressed ? "  REGRESSION" : "");
+        }
+        if (regressions > 0) {
+            std::fprintf(stderr, "%d benchmark(s) slower than the baseline by more than %g%%\n"
+                , regressions, options_.max_regression * 100.0);
+        }
+        return regressions > 0 ? 1 : 0;
+    }
+
+}
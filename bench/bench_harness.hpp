@@ -0,0 +1,136 @@
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    /**
+     * @struct Model
+     * @brief Floating point operations and memory traffic of a kernel, per grid point
+     *
+     * Counted from the loops of the kernel, a point read by several
+     * neighbours being loaded once. Iterative methods have a fixed part
+     * per operation (right-hand side, statistics) and a part per
+     * iteration; direct methods and plain kernels only the fixed part.
+     */
+    struct Model {
+        double flops = 0.0;         ///< Flops per point and operation
+        double bytes = 0.0;         ///< Bytes read or written per point and operation
+        double unit_flops = 0.0;    ///< Flops per point and iteration
+        double unit_bytes = 0.0;    ///< Bytes per point and iteration
+    };
+
+    /**
+     * @struct Result
+     * @brief Timing of one benchmark at one size
+     */
+    struct Result {
+        std::string name;           ///< Kernel, e.g. step_2d/multigrid
+        int n = 0;                  ///< Problem size, points per dimension
+        long long cells = 0;        ///< Points touched by one operation
+        long long ops = 0;          ///< Operations timed
+        double units = 0.0;         ///< Iterations per operation, 0 for direct kernels
+        double seconds = 0.0;       ///< Median time of one operation
+        double ns_per_cell = 0.0;   ///< seconds per point, in ns
+        double gflops = 0.0;        ///< From the model, 0 if it counts no flops
+        double gbytes_per_s = 0.0;  ///< From the model
+        double baseline = 0.0;      ///< ns_per_cell of the baseline, 0 if absent
+    };
+
+    /**
+     * @struct Options
+     * @brief Command line of a benchmark executable
+     */
+    struct Options {
+        double min_time = 0.5;          ///< Seconds spent timing each benchmark
+        int max_n = 0;                  ///< Largest size run, 0 for all
+        std::string filter;             ///< Run names containing this text only
+        std::string output;             ///< JSON file, empty for stdout
+        std::string baseline;           ///< JSON file of an earlier run to compare with
+        double max_regression = 0.0;    ///< Fail above this slowdown (0.1 for 10%), 0 to only report
+    };
+
+    /**
+     * @brief Parse `--key value` or `--key=value` arguments
+     * @throws std::invalid_argument on an unknown key or a malformed value
+     */
+    Options parse_options(const std::vector<std::string>& args);
+
+    /**
+     * @brief Get the command line help
+     */
+    std::string usage(const std::string& program);
+
+    /**
+     * @class Harness
+     * @brief Time operations and report them as JSON, against a baseline if any
+     *
+     * An operation is repeated in batches of at least a tenth of the time
+     * budget, until the budget and three batches are spent, and its time
+     * is the median over the batches, so clock resolution and outliers
+     * matter little. One untimed call precedes them, which builds the
+     * caches; an operation longer than the whole budget is timed once.
+     */
+    class Harness {
+        private:
+            std::string suite_;
+            Options options_;
+            std::vector<Result> results_;
+            std::map<std::string, double> baseline_;    ///< ns_per_cell by name and size
+
+            static std::string key(const std::string& name, int n);
+
+            /**
+             * @brief Read the results of an earlier run
+             * @throws std::runtime_error if the file cannot be read
+             */
+            void load_baseline(const std::string& path);
+
+        public:
+            /**
+             * @brief Start a suite
+             * @throws std::runtime_error if the baseline cannot be read
+             */
+            Harness(const std::string& suite, const Options& options);
+
+            /**
+             * @brief Check the filter and size limit before building anything
+             */
+            bool wants(const std::string& name, int n) const;
+
+            /**
+             * @brief Time an operation and record it
+             * @param name Kernel name
+             * @param n Problem size, points per dimension
+             * @param cells Points touched by one operation
+             * @param model Work of one operation per point
+             * @param op Operation, returning its number of iterations (0 for a direct kernel)
+             */
+            void run(
+                const std::string& name
+                , int n
+                , long long cells
+                , const Model& model
+                , const std::function<int()>& op
+            );
+
+            /**
+             * @brief Note a benchmark that cannot run here
+             */
+            void skip(const std::string& name, int n, const std::string& reason);
+
+            /**
+             * @brief Write the JSON report, and the comparison to stderr
+             * @return Exit status: 1 if a result regressed beyond max_regression
+             * @throws std::runtime_error if the output cannot be written
+             */
+            int finish();
+    };
+
+}
+
+#endif
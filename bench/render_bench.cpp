@@ -0,0 +1,115 @@
+#include "bench_harness.hpp"
+#include "sdl_core.hpp"
+#include "sdl_heatmap.hpp"
+#include "sdl_window.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    /// Offscreen target, the size of the application's window
+    const int WIDTH = 1400;
+    const int HEIGHT = 900;
+
+    /// Drawn size of the plate and of the bar, about those of the application
+    const int PLATE_SIZE = 700;
+    const int BAR_WIDTH = 900;
+    const int BAR_HEIGHT = 700;
+
+    /**
+     * @brief Smooth field in Kelvin, nx x ny row-major
+     */
+    std::vector<double> make_field(int nx, int ny) {
+        std::vector<double> field(static_cast<std::size_t>(nx) * ny);
+        for (int j = 0; j < ny; j++) {
+            for (int i = 0; i < nx; i++) {
+                double x = static_cast<double>(i) / nx;
+                double y = static_cast<double>(j) / std::max(ny, 2);
+                field[static_cast<std::size_t>(j) * nx + i] = 286.15 + 60.0 * std::sin(3.0 * x) * std::cos(2.0 * y);
+            }
+        }
+        return field;
+    }
+
+    /**
+     * @brief Colormap conversion and texture upload per grid point
+     *
+     * The renderer's scaling to the drawn size costs per pixel, not per
+     * point, so it shows in the time but not in the model.
+     */
+    bench::Model draw_model() {
+        bench::Model model;
+        model.flops = 2.0;
+        model.bytes = 16.0;
+        return model;
+    }
+
+    void bench_draw_plate_2d(bench::Harness& harness, sdl::SDLHeatmap& heatmap) {
+        for (int n : {51, 101, 201, 501, 1001, 2001}) {
+            if (!harness.wants("draw_plate_2d", n)) {
+                continue;
+            }
+            std::vector<double> field = make_field(n, n);
+            ensiie::FieldView view(field, n, n);
+            harness.run("draw_plate_2d", n, static_cast<long long>(n) * n, draw_model(), [&] {
+                heatmap.draw_plate_2d(view, 40, 100, PLATE_SIZE);
+                return 0;
+            });
+        }
+    }
+
+    void bench_draw_bar_1d(bench::Harness& harness, sdl::SDLHeatmap& heatmap) {
+        for (int n : {101, 1001, 10001}) {
+            if (!harness.wants("draw_bar_1d", n)) {
+                continue;
+            }
+            std::vector<double> field = make_field(n, 1);
+            ensiie::FieldView view(field, n, 1);
+            harness.run("draw_bar_1d", n, n, draw_model(), [&] {
+                heatmap.draw_bar_1d(view, 40, 100, BAR_WIDTH, BAR_HEIGHT);
+                return 0;
+            });
+        }
+    }
+}
+
+/**
+ * @brief Heatmap drawing benchmarks, into an offscreen surface
+ *
+ * The software renderer draws into memory, so no display is needed,
+ * only SDL_ttf and the font of the application.
+ */
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (const std::string& arg : args) {
+        if (arg == "--help" || arg == "-h") {
+            std::cout << bench::usage("render_bench");
+            return 0;
+        }
+    }
+
+    bench::Options options;
+    try {
+        options = bench::parse_options(args);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "render_bench: " << e.what() << "\n\n" << bench::usage("render_bench");
+        return 2;
+    }
+
+    try {
+        bench::Harness harness("render", options);
+        sdl::SDLCore::init(0);
+        {
+            sdl::SDLWindow target(WIDTH, HEIGHT);
+            sdl::SDLHeatmap heatmap(target, 273.15, 373.15);
+            bench_draw_plate_2d(harness, heatmap);
+            bench_draw_bar_1d(harness, heatmap);
+        }
+        sdl::SDLCore::quit();
+        return harness.finish();
+    } catch (const std::exception& e) {
+        std::cerr << "render_bench: " << e.what() << "\n";
+        return 1;
+    }
+}
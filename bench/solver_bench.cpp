@@ -0,0 +1,298 @@
+#include "bench_harness.hpp"
+#include "colormap.hpp"
+#include "heat_equation_ensemble_1d.hpp"
+#include "heat_equation_solver_1d.hpp"
+#include "heat_equation_solver_2d.hpp"
+#include "material.hpp"
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    using Method = ensiie::HeatEquationSolver2D::Method;
+
+    /// Parameters of the application's default run
+    const double L = 1.0;
+    const double TMAX = 16.0;
+    const double U0 = 13.0;
+    const double F = 80.0;
+
+    /// Largest plate for the banded Cholesky factor, n^3 doubles
+    const int MAX_CHOLESKY_N = 201;
+
+    /// Steps per call of the advance() benchmarks
+    const int ADVANCE_STEPS = 100;
+
+    /**
+     * @brief Work of one 2D step of a backend, per grid point
+     *
+     * Every step builds the right-hand side and the statistics, 8 flops
+     * and 48 bytes. An iteration is a sweep for Gauss-Seidel and SOR (the
+     * latter touching each row once per color), a V-cycle of two pre and
+     * two post red-black sweeps, a residual and the transfers over 4/3 of
+     * the points for multigrid, and a matrix product, two dot products,
+     * three updates and a V-cycle for conjugate gradient. ADI does two
+     * explicit half steps and two Thomas sweeps, spectral four cosine
+     * transforms of 2.5 log2(n) flops per point, and Cholesky a forward
+     * and a backward substitution in a band of n.
+     */
+    bench::Model step_2d_model(Method method, int n) {
+        bench::Model model;
+        model.flops = 8.0;
+        model.bytes = 48.0;
+        switch (method) {
+            case Method::GAUSS_SEIDEL:
+                model.unit_flops = 10.0;
+                model.unit_bytes = 24.0;
+                break;
+            case Method::RED_BLACK_SOR:
+                model.unit_flops = 12.0;
+                model.unit_bytes = 48.0;
+                break;
+            case Method::MULTIGRID:
+                model.unit_flops = 56.0;
+                model.unit_bytes = 320.0;
+                break;
+            case Method::CONJUGATE_GRADIENT:
+                model.unit_flops = 75.0;
+                model.unit_bytes = 440.0;
+                break;
+            case Method::ADI:
+                model.flops += 20.0;
+                model.bytes += 144.0;
+                break;
+            case Method::SPECTRAL:
+                model.flops += 10.0 * std::log2(static_cast<double>(n)) + 3.0;
+                model.bytes += 88.0;
+                break;
+            case Method::CHOLESKY:
+                model.flops += 4.0 * n;
+                model.bytes += 16.0 * n;
+                break;
+        }
+        return model;
+    }
+
+    /// Backend name as accepted by heat_batch
+    const char* slug(Method method) {
+        switch (method) {
+            case Method::GAUSS_SEIDEL:       return "gauss-seidel";
+            case Method::MULTIGRID:          return "multigrid";
+            case Method::RED_BLACK_SOR:      return "sor";
+            case Method::ADI:                return "adi";
+            case Method::SPECTRAL:           return "spectral";
+            case Method::CONJUGATE_GRADIENT: return "pcg";
+            case Method::CHOLESKY:           return "cholesky";
+        }
+        return "unknown";
+    }
+
+    void bench_step_1d(bench::Harness& harness) {
+        // Forward substitution adding the source, back substitution, statistics
+        bench::Model model;
+        model.flops = 13.0;
+        model.bytes = 88.0;
+
+        for (int n : {101, 1001, 10001, 100001, 1000001}) {
+            if (!harness.wants("step_1d", n)) {
+                continue;
+            }
+            ensiie::HeatEquationSolver1D solver(ensiie::Materials::COPPER, L, TMAX, U0, F, n);
+            solver.set_threads(1);
+            harness.run("step_1d", n, n, model, [&] {
+                if (!solver.step()) {
+                    solver.reset();
+                }
+                return 0;
+            });
+        }
+    }
+
+    void bench_step_2d(bench::Harness& harness) {
+        const Method methods[] = {
+            Method::GAUSS_SEIDEL, Method::MULTIGRID, Method::RED_BLACK_SOR, Method::ADI
+            , Method::SPECTRAL, Method::CONJUGATE_GRADIENT, Method::CHOLESKY
+        };
+
+        for (Method method : methods) {
+            std::string name = std::string("step_2d/") + slug(method);
+            for (int n : {51, 101, 201, 501, 1001, 2001}) {
+                if (!harness.wants(name, n)) {
+                    continue;
+                }
+                if (method == Method::CHOLESKY && n > MAX_CHOLESKY_N) {
+                    harness.skip(name, n, "banded factor too large");
+                    continue;
+                }
+                ensiie::HeatEquationSolver2D solver(ensiie::Materials::COPPER, L, TMAX, U0, F, n, method);
+                harness.run(name, n, static_cast<long long>(n) * n, step_2d_model(method, n), [&] {
+                    if (!solver.step()) {
+                        solver.reset();
+                    }
+                    return solver.get_last_step().iterations;
+                });
+            }
+        }
+    }
+
+    /**
+     * @brief advance() of ADVANCE_STEPS steps, counted per point and step
+     *
+     * The 1D substitutions run back to back with the statistics of the
+     * last step only, 64 bytes per point, as those of an ensemble of
+     * bars, counted per point of every bar. The partitioned bar, on all
+     * cores, adds the spike correction of 4 flops and 32 bytes. Spectral steps but the last are
+     * one geometric sum per mode: the cost hardly depends on the steps,
+     * so it has no model.
+     */
+    void bench_advance(bench::Harness& harness) {
+        bench::Model model_1d;
+        model_1d.flops = 6.0;
+        model_1d.bytes = 64.0;
+        for (int n : {1001, 100001}) {
+            if (!harness.wants("advance_1d", n)) {
+                continue;
+            }
+            ensiie::HeatEquationSolver1D solver(ensiie::Materials::COPPER, L, TMAX, U0, F, n);
+            solver.set_threads(1);
+            harness.run("advance_1d", n, static_cast<long long>(n) * ADVANCE_STEPS, model_1d, [&] {
+                if (solver.advance(ADVANCE_STEPS) < ADVANCE_STEPS) {
+                    solver.reset();
+                }
+                return 0;
+            });
+        }
+
+        bench::Model model_partitioned;
+        model_partitioned.flops = 10.0;
+        model_partitioned.bytes = 96.0;
+        for (int n : {1000001}) {
+            if (!harness.wants("advance_1d/partitioned", n)) {
+                continue;
+            }
+            ensiie::HeatEquationSolver1D solver(ensiie::Materials::COPPER, L, TMAX, U0, F, n);
+            harness.run("advance_1d/partitioned", n, static_cast<long long>(n) * ADVANCE_STEPS, model_partitioned, [&] {
+                if (solver.advance(ADVANCE_STEPS) < ADVANCE_STEPS) {
+                    solver.reset();
+                }
+                return 0;
+            });
+        }
+
+        for (int bars : {8, 64}) {
+            const int n = 1001;
+            const std::string name = "advance_ensemble_1d/" + std::to_string(bars);
+            if (!harness.wants(name, n)) {
+                continue;
+            }
+            const ensiie::Material mats[] = {ensiie::Materials::COPPER, ensiie::Materials::IRON
+                                             , ensiie::Materials::GLASS, ensiie::Materials::POLYSTYRENE};
+            std::vector<ensiie::BarSpec> specs;
+            for (int b = 0; b < bars; b++) {
+                specs.push_back({mats[b % 4], U0, F});
+            }
+            ensiie::HeatEquationEnsemble1D ensemble(specs, L, TMAX, n);
+            harness.run(name, n, static_cast<long long>(n) * bars * ADVANCE_STEPS, model_1d, [&] {
+                if (ensemble.advance(ADVANCE_STEPS) < ADVANCE_STEPS) {
+                    ensemble.reset();
+                }
+                return 0;
+            });
+        }
+
+        for (int n : {101, 501}) {
+            if (!harness.wants("advance_2d/spectral", n)) {
+                continue;
+            }
+            ensiie::HeatEquationSolver2D solver(ensiie::Materials::COPPER, L, TMAX, U0, F, n, Method::SPECTRAL);
+            harness.run("advance_2d/spectral", n, static_cast<long long>(n) * n * ADVANCE_STEPS, bench::Model(), [&] {
+                if (solver.advance(ADVANCE_STEPS) < ADVANCE_STEPS) {
+                    solver.reset();
+                }
+                return 0;
+            });
+        }
+    }
+
+    void bench_get_temperature_2d(bench::Harness& harness) {
+        // Read and copy, plus one allocation per row
+        bench::Model model;
+        model.bytes = 16.0;
+
+        for (int n : {51, 101, 201, 501, 1001, 2001}) {
+            if (!harness.wants("get_temperature_2d", n)) {
+                continue;
+            }
+            ensiie::HeatEquationSolver2D solver(ensiie::Materials::COPPER, L, TMAX, U0, F, n);
+            harness.run("get_temperature_2d", n, static_cast<long long>(n) * n, model, [&] {
+                std::vector<std::vector<double>> temps = solver.get_temperature_2d();
+                return temps.empty() ? 1 : 0;
+            });
+        }
+    }
+
+    void bench_colormap(bench::Harness& harness) {
+        // One multiply-add per value, a double read and a color written, the table in cache
+        bench::Model model;
+        model.flops = 2.0;
+        model.bytes = 12.0;
+
+        for (int n : {101, 501, 1001, 2001}) {
+            if (!harness.wants("colormap", n)) {
+                continue;
+            }
+            const int count = n * n;
+            std::vector<double> temps(count);
+            for (int k = 0; k < count; k++) {
+                temps[k] = 280.0 + 80.0 * std::sin(0.001 * k);
+            }
+            std::vector<std::uint32_t> colors(count);
+            sdl::Colormap colormap(sdl::Palette::INFERNO);
+            colormap.set_range(270.0, 370.0);
+
+            harness.run("colormap", n, count, model, [&] {
+                colormap.map(temps.data(), count, colors.data());
+                return 0;
+            });
+        }
+    }
+}
+
+/**
+ * @brief Solver benchmarks: 1D and 2D steps, multi-step advance, field copy and colormap
+ *
+ * Links the solver library and the colormap only, so it runs on
+ * machines without a display server.
+ */
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (const std::string& arg : args) {
+        if (arg == "--help" || arg == "-h") {
+            std::cout << bench::usage("solver_bench");
+            return 0;
+        }
+    }
+
+    bench::Options options;
+    try {
+        options = bench::parse_options(args);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "solver_bench: " << e.what() << "\n\n" << bench::usage("solver_bench");
+        return 2;
+    }
+
+    try {
+        bench::Harness harness("solvers", options);
+        bench_step_1d(harness);
+        bench_step_2d(harness);
+        bench_advance(harness);
+        bench_get_temperature_2d(harness);
+        bench_colormap(harness);
+        return harness.finish();
+    } catch (const std::exception& e) {
+        std::cerr << "solver_bench: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,98 @@
+#include "banded_cholesky.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ensiie {
+    namespace {
+        /**
+         * @brief Dot product with four partial sums, so the additions pipeline
+         */
+        inline double dot(const double* a, const double* b, int count)
+        {
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            int k = 0;
+            for (; k + 4 <= count; k += 4) {
+                s0 += a[k] * b[k];
+                s1 += a[k + 1] * b[k + 1];
+                s2 += a[k + 2] * b[k + 2];
+                s3 += a[k + 3] * b[k + 3];
+            }
+            for (; k < count; k++) {
+                s0 += a[k] * b[k];
+            }
+            return (s0 + s1) + (s2 + s3);
+        }
+    }
+
+    BandedCholesky::BandedCholesky(int size, int band)
+    : size_(size)
+    , band_(band)
+    , L_(static_cast<long>(size) * (band + 1), 0.0)
+    , inv_diag_(size, 0.0)
+    , factorized_(false)
+    {
+    }
+
+    void BandedCholesky::factorize()
+    {
+        const int b = band_;
+
+        // Row by row: L(i,j) = (A(i,j) - sum_k L(i,k) L(j,k)) / L(j,j),
+        // both rows being contiguous over k
+        for (int i = 0; i < size_; i++) {
+            double* row_i = L_.data() + static_cast<long>(i) * (b + 1);
+            int j0 = std::max(0, i - b);
+
+            for (int j = j0; j <= i; j++) {
+                const double* row_j = L_.data() + static_cast<long>(j) * (b + 1);
+                int k0 = std::max(j0, j - b);
+
+                double s = row_i[j - i + b]
+                           - dot(row_i + (k0 - i + b), row_j + (k0 - j + b), j - k0);
+
+                if (j < i) {
+                    row_i[j - i + b] = s * inv_diag_[j];
+                } else {
+                    if (s <= 0.0) {
+                        throw std::runtime_error("BandedCholesky: matrix is not positive definite");
+                    }
+                    row_i[b] = std::sqrt(s);
+                    inv_diag_[i] = 1.0 / row_i[b];
+                }
+            }
+        }
+
+        factorized_ = true;
+    }
+
+    void BandedCholesky::solve(double* d) const
+    {
+        if (!factorized_) {
+            throw std::runtime_error("BandedCholesky: solve before factorize");
+        }
+
+        const int b = band_;
+        const double* L = L_.data();
+
+        // Forward substitution L y = d, row access
+        for (int i = 0; i < size_; i++) {
+            const double* row = L + static_cast<long>(i) * (b + 1);
+            int k0 = std::max(0, i - b);
+
+            d[i] = (d[i] - dot(row + (k0 - i + b), d + k0, i - k0)) * inv_diag_[i];
+        }
+
+        // Backward substitution L^T x = y, column i of L^T is row i of L
+        for (int i = size_ - 1; i >= 0; i--) {
+            const double* row = L + static_cast<long>(i) * (b + 1);
+            int k0 = std::max(0, i - b);
+
+            d[i] *= inv_diag_[i];
+            double x = d[i];
+            for (int k = k0; k < i; k++) {
+                d[k] -= row[k - i + b] * x;
+            }
+        }
+    }
+}
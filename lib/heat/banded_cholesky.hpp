@@ -0,0 +1,62 @@
+#ifndef BANDED_CHOLESKY_HPP
+#define BANDED_CHOLESKY_HPP
+
+#include <vector>
+
+namespace ensiie {
+    /**
+     * @class BandedCholesky
+     * @brief Cholesky factorization L*L^T of a symmetric positive definite band matrix
+     *
+     * Only the lower band is stored, row by row: entry (i, j) with
+     * i - b <= j <= i sits at i*(b+1) + (j - i + b). The factor has the
+     * same band, so memory is size*(b+1) and the factorization costs
+     * O(size*b²), each solve O(size*b).
+     */
+    class BandedCholesky
+    {
+        private:
+            int size_;                      ///< Matrix order
+            int band_;                      ///< Number of sub-diagonals b
+            std::vector<double> L_;         ///< Lower band, matrix then factor
+            std::vector<double> inv_diag_;  ///< 1 / L(i,i)
+            bool factorized_;               ///< factorize() was called
+
+        public:
+            /**
+             * @brief Constructor, the matrix starts at zero
+             * @param size Matrix order
+             * @param band Number of sub-diagonals
+             */
+            BandedCholesky(int size, int band);
+
+            /**
+             * @brief Access entry (i, j) of the lower band, i - b <= j <= i
+             */
+            double& at(int i, int j) { return L_[static_cast<long>(i) * (band_ + 1) + (j - i + band_)]; }
+
+            /**
+             * @brief Replace the matrix by its Cholesky factor
+             * @throws std::runtime_error if the matrix is not positive definite
+             */
+            void factorize();
+
+            /**
+             * @brief Solve L*L^T x = d in place
+             * @param d Right hand side on input, solution on output (size values)
+             */
+            void solve(double* d) const;
+
+            /**
+             * @brief Get matrix order
+             */
+            int size() const { return size_; }
+
+            /**
+             * @brief Get number of sub-diagonals
+             */
+            int band() const { return band_; }
+    };
+}
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef BOUNDARY_CONDITIONS_HPP
+#define BOUNDARY_CONDITIONS_HPP
+
+namespace ensiie {
+/**
+ * @brief Kind of condition imposed on one side of the domain
+ */
+enum class BoundaryType {
+    NEUMANN,    ///< Insulated side, zero flux
+    DIRICHLET,  ///< Fixed temperature
+    ROBIN,      ///< Convective exchange -λ du/dn = h (u - u_ext)
+    PERIODIC    ///< Wraps to the opposite side, which must be periodic too
+};
+
+/**
+ * @brief Condition on one side of the domain
+ */
+struct BoundaryCondition {
+    BoundaryType type;   ///< Kind of condition
+    double value;        ///< Dirichlet or Robin external temperature (Celsius)
+    double coefficient;  ///< Robin h/λ (1/m)
+
+    static BoundaryCondition neumann() { return {BoundaryType::NEUMANN, 0.0, 0.0}; }
+    static BoundaryCondition dirichlet(double value) { return {BoundaryType::DIRICHLET, value, 0.0}; }
+    static BoundaryCondition robin(double h_over_lambda, double value) { return {BoundaryType::ROBIN, value, h_over_lambda}; }
+    static BoundaryCondition periodic() { return {BoundaryType::PERIODIC, 0.0, 0.0}; }
+};
+
+/**
+ * @brief Compile-time boundary policies
+ *
+ * Solvers instantiate their boundary loops for each policy, so the
+ * condition is resolved once per side instead of once per cell.
+ * With the ghost point u_g beyond a Neumann or Robin boundary node u_b,
+ * eliminated with the central difference of the flux condition,
+ *   u_g = u_in - 2 Δx (h/λ) (u_b - u_ext)
+ * exchange() returns Δx·h/λ, which is 0 for the insulated side.
+ */
+namespace boundary {
+    struct Neumann {
+        static constexpr BoundaryType type = BoundaryType::NEUMANN;
+        static constexpr bool fixed    = false;    ///< Boundary node is not an unknown
+        static constexpr bool periodic = false;    ///< Boundary node wraps around
+        static constexpr double exchange(const BoundaryCondition&, double) { return 0.0; }
+    };
+
+    struct Dirichlet {
+        static constexpr BoundaryType type = BoundaryType::DIRICHLET;
+        static constexpr bool fixed    = true;
+        static constexpr bool periodic = false;
+        static constexpr double exchange(const BoundaryCondition&, double) { return 0.0; }
+    };
+
+    struct Robin {
+        static constexpr BoundaryType type = BoundaryType::ROBIN;
+        static constexpr bool fixed    = false;
+        static constexpr bool periodic = false;
+        static double exchange(const BoundaryCondition& bc, double dx) { return bc.coefficient * dx; }
+    };
+
+    struct Periodic {
+        static constexpr BoundaryType type = BoundaryType::PERIODIC;
+        static constexpr bool fixed    = false;
+        static constexpr bool periodic = true;
+        static constexpr double exchange(const BoundaryCondition&, double) { return 0.0; }
+    };
+
+    /**
+     * @brief One-sided boundary row of a bar for a side policy
+     *
+     * The boundary node and its inner neighbour only:
+     * - fixed:  u_b = value
+     * - flux:   (1 + Δx h/λ) u_b - u_in = Δx h/λ u_ext
+     * @param value Fixed or external temperature of the side, in K
+     * @param diag Coefficient of u_b
+     * @param inner Coefficient of u_in
+     * @param rhs Right hand side of the row, constant during a run
+     */
+    template <class Side>
+    void bar_row(const BoundaryCondition& bc, double dx, double value, double& diag, double& inner, double& rhs)
+    {
+        if constexpr (Side::fixed) {
+            diag  = 1.0;
+            inner = 0.0;
+            rhs   = value;
+        } else {
+            double e = Side::exchange(bc, dx);
+            diag  = 1.0 + e;
+            inner = -1.0;
+            rhs   = e * value;
+        }
+    }
+
+    /**
+     * @brief Call fn with the policy object matching a runtime type
+     */
+    template <class Fn>
+    void visit(BoundaryType type, Fn&& fn)
+    {
+        switch (type) {
+            case BoundaryType::NEUMANN:   fn(Neumann{});   break;
+            case BoundaryType::DIRICHLET: fn(Dirichlet{}); break;
+            case BoundaryType::ROBIN:     fn(Robin{});     break;
+            case BoundaryType::PERIODIC:  fn(Periodic{});  break;
+        }
+    }
+}
+
+/**
+ * @brief Get display name of a boundary type
+ */
+inline const char* to_string(BoundaryType type)
+{
+    switch (type) {
+        case BoundaryType::NEUMANN:   return "Neumann";
+        case BoundaryType::DIRICHLET: return "Dirichlet";
+        case BoundaryType::ROBIN:     return "Robin";
+        case BoundaryType::PERIODIC:  return "Periodic";
+    }
+    return "Unknown";
+}
+}
+
+#endif
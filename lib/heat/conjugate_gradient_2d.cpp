@@ -0,0 +1,149 @@
+#include "conjugate_gradient_2d.hpp"
+#include "stencil_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ensiie {
+    ConjugateGradient2D::ConjugateGradient2D(int n, double r, Preconditioner preconditioner)
+    : n_(n)
+    , r_(r)
+    , preconditioner_(preconditioner)
+    , weight_(n, 1.0)
+    , res_(n * n, 0.0)
+    , z_(n * n, 0.0)
+    , p_(n * n, 0.0)
+    , q_(n * n, 0.0)
+    , last_iterations_(0)
+    , last_residual_(0.0)
+    {
+        // Half control volume on the Neumann side, no unknown on the Dirichlet one
+        weight_[0]     = 0.5;
+        weight_[n - 1] = 0.0;
+    }
+
+    void ConjugateGradient2D::set_rate(double r)
+    {
+        r_ = r;
+        if (multigrid_) {
+            multigrid_->set_rate(r);
+        }
+    }
+
+    void ConjugateGradient2D::apply(const double* x, double* y) const
+    {
+        const int n = n_;
+        const double r = r_;
+        const double diag = 1.0 + 4.0 * r;
+        const StencilKernels& kernels = stencil_kernels();
+
+        for (int j = 0; j < n - 1; j++) {
+            // Neumann BC at j=0: mirror row 1
+            const double* dn = x + (j > 0 ? j - 1 : 1) * n;
+            const double* up = x + (j + 1) * n;
+            const double* row = x + j * n;
+            double* out = y + j * n;
+
+            // Neumann BC at i=0: mirror column 1
+            out[0] = diag * row[0] - r * (2.0 * row[1] + dn[0] + up[0]);
+            kernels.apply(dn, row, up, out, 1, n - 1, diag, r);
+            out[n - 1] = 0.0;
+        }
+        std::fill(y + (n - 1) * n, y + n * n, 0.0);
+    }
+
+    double ConjugateGradient2D::dot(const double* a, const double* b) const
+    {
+        const int n = n_;
+        double sum = 0.0;
+
+        for (int j = 0; j < n - 1; j++) {
+            const double* aj = a + j * n;
+            const double* bj = b + j * n;
+
+            double row = weight_[0] * aj[0] * bj[0];
+            for (int i = 1; i < n - 1; i++) {
+                row += aj[i] * bj[i];
+            }
+            sum += weight_[j] * row;
+        }
+
+        return sum;
+    }
+
+    void ConjugateGradient2D::precondition()
+    {
+        if (preconditioner_ == Preconditioner::MULTIGRID) {
+            if (!multigrid_) {
+                multigrid_ = std::make_unique<Multigrid2D>(n_, r_);
+            }
+            multigrid_->precondition(res_, z_);
+            return;
+        }
+
+        // Constant diagonal, Dirichlet points of res_ are already zero
+        const double inv_diag = 1.0 / (1.0 + 4.0 * r_);
+        for (int k = 0; k < n_ * n_; k++) {
+            z_[k] = inv_diag * res_[k];
+        }
+    }
+
+    int ConjugateGradient2D::solve(
+        std::vector<double>& u
+        , const std::vector<double>& rhs
+        , double tol
+        , int max_iter
+    ) {
+        const int size = n_ * n_;
+
+        // res = rhs - A*u, zero on Dirichlet points
+        apply(u.data(), res_.data());
+        for (int j = 0; j < n_ - 1; j++) {
+            for (int i = 0; i < n_ - 1; i++) {
+                res_[j * n_ + i] = rhs[j * n_ + i] - res_[j * n_ + i];
+            }
+        }
+
+        // Dirichlet entries of rhs have a zero weight
+        double rhs_norm = std::sqrt(dot(rhs.data(), rhs.data()));
+        if (rhs_norm == 0.0) {
+            rhs_norm = 1.0;
+        }
+
+        last_iterations_ = 0;
+        last_residual_ = std::sqrt(dot(res_.data(), res_.data())) / rhs_norm;
+        if (last_residual_ <= tol) {
+            return 0;
+        }
+
+        precondition();
+        p_ = z_;
+        double rz = dot(res_.data(), z_.data());
+
+        while (last_iterations_ < max_iter) {
+            apply(p_.data(), q_.data());
+            double alpha = rz / dot(p_.data(), q_.data());
+
+            for (int k = 0; k < size; k++) {
+                u[k]    += alpha * p_[k];
+                res_[k] -= alpha * q_[k];
+            }
+            last_iterations_++;
+
+            last_residual_ = std::sqrt(dot(res_.data(), res_.data())) / rhs_norm;
+            if (last_residual_ <= tol) {
+                break;
+            }
+
+            precondition();
+            double rz_next = dot(res_.data(), z_.data());
+            double beta = rz_next / rz;
+            rz = rz_next;
+
+            for (int k = 0; k < size; k++) {
+                p_[k] = z_[k] + beta * p_[k];
+            }
+        }
+
+        return last_iterations_;
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef CONJUGATE_GRADIENT_2D_HPP
+#define CONJUGATE_GRADIENT_2D_HPP
+
+#include "multigrid_2d.hpp"
+#include <memory>
+#include <vector>
+
+namespace ensiie {
+    /**
+     * @class ConjugateGradient2D
+     * @brief Matrix-free preconditioned conjugate gradient for the 2D implicit heat system
+     *
+     * Solves the same system as Multigrid2D, applying the 5-point stencil
+     * on the fly. The Neumann mirror makes the matrix non-symmetric, but it
+     * is self-adjoint for the inner product weighted by the control volumes
+     * (1/2 on the i=0 and j=0 lines), which is the one used by the iteration.
+     */
+    class ConjugateGradient2D
+    {
+        public:
+            /**
+             * @brief Approximation of A^-1 applied to the residual
+             */
+            enum class Preconditioner {
+                JACOBI,     ///< Inverse of the diagonal
+                MULTIGRID   ///< One symmetric V-cycle
+            };
+
+        private:
+            int n_;                                 ///< Points per dimension
+            double r_;                              ///< Stencil coefficient α*Δt/Δx²
+            Preconditioner preconditioner_;         ///< Selected preconditioner
+            std::unique_ptr<Multigrid2D> multigrid_; ///< V-cycle preconditioner, built on first use
+
+            std::vector<double> weight_;            ///< Volume weight of a line index, 0 on Dirichlet
+            std::vector<double> res_;               ///< Residual
+            std::vector<double> z_;                 ///< Preconditioned residual
+            std::vector<double> p_;                 ///< Search direction
+            std::vector<double> q_;                 ///< A * p_
+
+            int last_iterations_;                   ///< Iterations of the last solve
+            double last_residual_;                  ///< Relative residual after the last solve
+
+            /**
+             * @brief y = A*x on the unknowns, 0 on Dirichlet points
+             */
+            void apply(const double* x, double* y) const;
+
+            /**
+             * @brief Volume weighted inner product over the unknowns
+             */
+            double dot(const double* a, const double* b) const;
+
+            /**
+             * @brief z_ = M^-1 * res_
+             */
+            void precondition();
+
+        public:
+            /**
+             * @brief Constructor
+             * @param n Number of points per dimension
+             * @param r Stencil coefficient α*Δt/Δx²
+             * @param preconditioner Preconditioner applied to the residual
+             */
+            ConjugateGradient2D(int n, double r, Preconditioner preconditioner = Preconditioner::MULTIGRID);
+
+            /**
+             * @brief Iterate until ||rhs - A*u|| <= tol * ||rhs||
+             * @param u Initial guess on input, solution on output (n*n)
+             * @param rhs Right hand side (n*n)
+             * @param tol Tolerance on the relative residual norm
+             * @param max_iter Maximum number of iterations
+             * @return Number of iterations done
+             */
+            int solve(
+                std::vector<double>& u
+                , const std::vector<double>& rhs
+                , double tol
+                , int max_iter
+            );
+
+            /**
+             * @brief Change the stencil coefficient, keeping the work vectors
+             */
+            void set_rate(double r);
+
+            /**
+             * @brief Select the preconditioner of the next solves
+             */
+            void set_preconditioner(Preconditioner preconditioner) { preconditioner_ = preconditioner; }
+
+            /**
+             * @brief Get the selected preconditioner
+             */
+            Preconditioner get_preconditioner() const { return preconditioner_; }
+
+            /**
+             * @brief Get number of iterations of the last solve
+             */
+            int get_last_iterations() const { return last_iterations_; }
+
+            /**
+             * @brief Get ||rhs - A*u|| / ||rhs|| after the last solve
+             */
+            double get_last_residual() const { return last_residual_; }
+    };
+}
+
+#endif
@@ -0,0 +1,302 @@
+#include "cosine_transform.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ensiie {
+    namespace {
+        const double PI = 3.14159265358979323846;
+
+        /// Radices of the core FFT, odd primes get a direct DFT butterfly
+        const int RADICES[] = {4, 2, 3, 5, 7, 11, 13};
+
+        /**
+         * @brief Split n in RADICES
+         * @return false if n has another prime factor
+         */
+        bool factorize(int n, std::vector<int>& radices)
+        {
+            radices.clear();
+            for (int p : RADICES) {
+                while (n % p == 0) {
+                    radices.push_back(p);
+                    n /= p;
+                }
+            }
+            return n == 1;
+        }
+
+        /// Complex product without the C99 inf/nan recovery of operator*
+        inline std::complex<double> mul(const std::complex<double>& a, const std::complex<double>& b)
+        {
+            return std::complex<double>(a.real() * b.real() - a.imag() * b.imag()
+                                        , a.real() * b.imag() + a.imag() * b.real());
+        }
+
+        /// Offset of the radix p roots in roots_
+        int root_offset(int p)
+        {
+            int offset = 0;
+            for (int q : RADICES) {
+                if (q == p) {
+                    break;
+                }
+                offset += (q % 2 == 1) ? q : 0;
+            }
+            return offset;
+        }
+    }
+
+    CosineTransform::CosineTransform(int n)
+    : n_(n)
+    , fft_n_(n)
+    , bluestein_(false)
+    {
+        if (!factorize(n, radices_)) {
+            // Linear convolution of length 2n-1 without wrap around
+            bluestein_ = true;
+            fft_n_ = 1;
+            while (fft_n_ < 2 * n - 1) {
+                fft_n_ *= 2;
+            }
+            factorize(fft_n_, radices_);
+        }
+
+        // Stage with radix R after a span of Ns: exp(-2iπ j r / (Ns R)), j < Ns, r < R
+        int span = 1;
+        for (int radix : radices_) {
+            for (int j = 0; j < span; j++) {
+                for (int r = 0; r < radix; r++) {
+                    twiddle_.push_back(std::polar(1.0, -2.0 * PI * j * r / (span * radix)));
+                }
+            }
+            span *= radix;
+        }
+
+        for (int p : RADICES) {
+            if (p % 2 == 0) {
+                continue;
+            }
+            for (int k = 0; k < p; k++) {
+                roots_.push_back(std::polar(1.0, -2.0 * PI * k / p));
+            }
+        }
+
+        shift_.resize(n_);
+        for (int k = 0; k < n_; k++) {
+            shift_[k] = std::polar(1.0, -PI * k / (2.0 * n_));
+        }
+
+        if (bluestein_) {
+            // chirp[k] = exp(-iπk²/n), k² taken modulo 2n to keep the angle accurate
+            chirp_.resize(n_);
+            for (int k = 0; k < n_; k++) {
+                long long k2 = (static_cast<long long>(k) * k) % (2LL * n_);
+                chirp_[k] = std::polar(1.0, -PI * static_cast<double>(k2) / n_);
+            }
+
+            chirp_fft_.assign(fft_n_, Complex(0.0, 0.0));
+            chirp_fft_[0] = std::conj(chirp_[0]);
+            for (int k = 1; k < n_; k++) {
+                chirp_fft_[k]          = std::conj(chirp_[k]);
+                chirp_fft_[fft_n_ - k] = std::conj(chirp_[k]);
+            }
+            std::vector<Complex> scratch(fft_n_);
+            fft_core(chirp_fft_.data(), scratch.data());
+        }
+    }
+
+    void CosineTransform::fft_core(Complex* x, Complex* scratch) const
+    {
+        // Stockham autosort: every stage reads one buffer and writes the other
+        const int n = fft_n_;
+        Complex* src = x;
+        Complex* dst = scratch;
+        const Complex* tw = twiddle_.data();
+        int span = 1;
+
+        for (int radix : radices_) {
+            const int stride = n / radix;
+            Complex v[13];
+
+            for (int block = 0; block < stride / span; block++) {
+                Complex* out_block = dst + block * span * radix;
+
+                for (int jm = 0; jm < span; jm++) {
+                    const int j = block * span + jm;
+                    const Complex* w = tw + jm * radix;
+
+                    if (span == 1) {
+                        // First stage, all twiddles are 1
+                        for (int r = 0; r < radix; r++) {
+                            v[r] = src[j + r * stride];
+                        }
+                    } else {
+                        for (int r = 0; r < radix; r++) {
+                            v[r] = mul(src[j + r * stride], w[r]);
+                        }
+                    }
+
+                    Complex* out = out_block + jm;
+                    switch (radix) {
+                        case 2:
+                            out[0]    = v[0] + v[1];
+                            out[span] = v[0] - v[1];
+                            break;
+                        case 4: {
+                            Complex a = v[0] + v[2];
+                            Complex b = v[0] - v[2];
+                            Complex c = v[1] + v[3];
+                            Complex d = v[1] - v[3];
+                            Complex d_rot(d.imag(), -d.real());     // -i * d
+                            out[0]        = a + c;
+                            out[span]     = b + d_rot;
+                            out[2 * span] = a - c;
+                            out[3 * span] = b - d_rot;
+                            break;
+                        }
+                        default: {
+                            // Direct DFT of a small prime radix
+                            const Complex* root = roots_.data() + root_offset(radix);
+                            for (int k = 0; k < radix; k++) {
+                                Complex sum = v[0];
+                                for (int r = 1; r < radix; r++) {
+                                    sum += mul(v[r], root[(r * k) % radix]);
+                                }
+                                out[k * span] = sum;
+                            }
+                            break;
+                        }
+                    }
+                }
+            }
+
+            std::swap(src, dst);
+            tw += span * radix;
+            span *= radix;
+        }
+
+        if (src != x) {
+            std::copy(src, src + n, x);
+        }
+    }
+
+    void CosineTransform::fft(Complex* x, Complex* work) const
+    {
+        if (!bluestein_) {
+            fft_core(x, work);
+            return;
+        }
+
+        // Bluestein: X[k] = chirp[k] * sum_i (x[i] chirp[i]) conj(chirp[k-i])
+        Complex* a = work;
+        Complex* scratch = work + fft_n_;
+        for (int k = 0; k < n_; k++) {
+            a[k] = mul(x[k], chirp_[k]);
+        }
+        for (int k = n_; k < fft_n_; k++) {
+            a[k] = Complex(0.0, 0.0);
+        }
+
+        fft_core(a, scratch);
+        for (int k = 0; k < fft_n_; k++) {
+            a[k] = std::conj(mul(a[k], chirp_fft_[k]));
+        }
+        fft_core(a, scratch);
+
+        double scale = 1.0 / fft_n_;
+        for (int k = 0; k < n_; k++) {
+            x[k] = mul(chirp_[k], std::conj(a[k])) * scale;
+        }
+    }
+
+    void CosineTransform::dct2(double* x, Complex* work) const
+    {
+        // Makhoul: even samples forward, odd samples backward
+        Complex* v = work;
+        for (int i = 0; 2 * i < n_; i++) {
+            v[i] = Complex(x[2 * i], 0.0);
+        }
+        for (int i = 0; 2 * i + 1 < n_; i++) {
+            v[n_ - 1 - i] = Complex(x[2 * i + 1], 0.0);
+        }
+
+        fft(v, work + n_);
+
+        // y[k] = Re(exp(-iπk/(2N)) V[k])
+        for (int k = 0; k < n_; k++) {
+            x[k] = mul(shift_[k], v[k]).real();
+        }
+    }
+
+    void CosineTransform::dct3(double* x, Complex* work) const
+    {
+        // Inverse of the Makhoul DCT-II scaled by N/2:
+        //   V[k] = exp(iπk/(2N)) (x[k] - i x[N-k]),  x[N] = 0
+        //   v    = IFFT(V) * N/2 = conj(FFT(conj(V))) / 2
+        Complex* v = work;
+        v[0] = std::conj(mul(std::conj(shift_[0]), Complex(x[0], 0.0)));
+        for (int k = 1; k < n_; k++) {
+            v[k] = std::conj(mul(std::conj(shift_[k]), Complex(x[k], -x[n_ - k])));
+        }
+
+        fft(v, work + n_);
+
+        for (int i = 0; 2 * i < n_; i++) {
+            x[2 * i] = 0.5 * v[i].real();
+        }
+        for (int i = 0; 2 * i + 1 < n_; i++) {
+            x[2 * i + 1] = 0.5 * v[n_ - 1 - i].real();
+        }
+    }
+
+    void CosineTransform::dct2_pair(double* x, double* y, Complex* work) const
+    {
+        // Both real inputs share one FFT: v = vx + i vy
+        Complex* v = work;
+        for (int i = 0; 2 * i < n_; i++) {
+            v[i] = Complex(x[2 * i], y[2 * i]);
+        }
+        for (int i = 0; 2 * i + 1 < n_; i++) {
+            v[n_ - 1 - i] = Complex(x[2 * i + 1], y[2 * i + 1]);
+        }
+
+        fft(v, work + n_);
+
+        // Split with Hermitian symmetry: Vx[k] = (V[k] + conj(V[N-k]))/2
+        //                                 Vy[k] = (V[k] - conj(V[N-k]))/(2i)
+        for (int k = 0; k < n_; k++) {
+            Complex a = v[k];
+            Complex b = std::conj(v[k == 0 ? 0 : n_ - k]);
+            Complex vx = 0.5 * (a + b);
+            Complex vy = 0.5 * (a - b);
+            vy = Complex(vy.imag(), -vy.real());
+            x[k] = mul(shift_[k], vx).real();
+            y[k] = mul(shift_[k], vy).real();
+        }
+    }
+
+    void CosineTransform::dct3_pair(double* x, double* y, Complex* work) const
+    {
+        // FFT(conj(V)) is real for a real result, so the second
+        // transform rides in the imaginary part
+        Complex* v = work;
+        v[0] = std::conj(mul(std::conj(shift_[0]), Complex(x[0], 0.0)))
+               + Complex(0.0, 1.0) * std::conj(mul(std::conj(shift_[0]), Complex(y[0], 0.0)));
+        for (int k = 1; k < n_; k++) {
+            Complex vx = std::conj(mul(std::conj(shift_[k]), Complex(x[k], -x[n_ - k])));
+            Complex vy = std::conj(mul(std::conj(shift_[k]), Complex(y[k], -y[n_ - k])));
+            v[k] = Complex(vx.real() - vy.imag(), vx.imag() + vy.real());
+        }
+
+        fft(v, work + n_);
+
+        for (int i = 0; 2 * i < n_; i++) {
+            x[2 * i] = 0.5 * v[i].real();
+            y[2 * i] = 0.5 * v[i].imag();
+        }
+        for (int i = 0; 2 * i + 1 < n_; i++) {
+            x[2 * i + 1] = 0.5 * v[n_ - 1 - i].real();
+            y[2 * i + 1] = 0.5 * v[n_ - 1 - i].imag();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef COSINE_TRANSFORM_HPP
+#define COSINE_TRANSFORM_HPP
+
+#include <complex>
+#include <vector>
+
+namespace ensiie {
+    /**
+     * @class CosineTransform
+     * @brief Fast DCT-II / DCT-III of any length, through a complex FFT
+     *
+     * Uses Makhoul's reordering so that both transforms are one complex
+     * FFT of the same length N. Lengths made of primes up to 13 use
+     * a mixed-radix Stockham FFT, other lengths use Bluestein's chirp-z
+     * algorithm on a power of two size, so every transform is O(N log N).
+     *
+     * Methods are const and take their scratch memory as argument, so one
+     * transform can be shared by several threads with one workspace each.
+     */
+    class CosineTransform
+    {
+        private:
+            using Complex = std::complex<double>;
+
+            int n_;                         ///< Transform length
+            int fft_n_;                     ///< Core FFT length (n_ or Bluestein size)
+            bool bluestein_;                ///< n_ has a prime factor above 7
+
+            std::vector<int> radices_;      ///< Stockham stages of the core FFT
+            std::vector<Complex> twiddle_;  ///< Twiddles of all stages, stage after stage
+            std::vector<Complex> roots_;    ///< exp(-2iπk/p), k < p, for odd radices p in a row
+            std::vector<Complex> chirp_;    ///< exp(-iπk²/n_), k < n_
+            std::vector<Complex> chirp_fft_;///< FFT of the zero padded conjugate chirp
+            std::vector<Complex> shift_;    ///< exp(-iπk/(2n_)), k < n_
+
+            /**
+             * @brief In place mixed-radix FFT of length fft_n_ (sign -1)
+             * @param scratch fft_n_ values
+             */
+            void fft_core(Complex* x, Complex* scratch) const;
+
+            /**
+             * @brief In place FFT of length n_ (sign -1)
+             * @param work fft_n_ values, plus fft_n_ more with Bluestein
+             */
+            void fft(Complex* x, Complex* work) const;
+
+        public:
+            /**
+             * @brief Constructor
+             * @param n Transform length
+             */
+            explicit CosineTransform(int n);
+
+            /**
+             * @brief Number of complex values needed as workspace
+             */
+            int workspace_size() const { return n_ + fft_n_ * (bluestein_ ? 2 : 1); }
+
+            /**
+             * @brief In place DCT-II: y[k] = sum_i x[i] cos(πk(2i+1)/(2N))
+             * @param work At least workspace_size() values
+             */
+            void dct2(double* x, Complex* work) const;
+
+            /**
+             * @brief In place DCT-III: y[k] = x[0]/2 + sum_{i>0} x[i] cos(πi(2k+1)/(2N))
+             *
+             * dct2(dct3(x)) = (N/2) x
+             * @param work At least workspace_size() values
+             */
+            void dct3(double* x, Complex* work) const;
+
+            /**
+             * @brief In place DCT-II of two lines with a single complex FFT
+             * @param work At least workspace_size() values
+             */
+            void dct2_pair(double* x, double* y, Complex* work) const;
+
+            /**
+             * @brief In place DCT-III of two lines with a single complex FFT
+             * @param work At least workspace_size() values
+             */
+            void dct3_pair(double* x, double* y, Complex* work) const;
+
+            /**
+             * @brief Get transform length
+             */
+            int size() const { return n_; }
+    };
+}
+
+#endif
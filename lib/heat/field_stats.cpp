@@ -0,0 +1,21 @@
+#include "field_stats.hpp"
+
+/// Celsius to Kelvin conversion
+constexpr double KELVIN_OFFSET = 273.15;
+
+namespace ensiie {
+
+    double outward_flux(const BoundaryCondition& bc, double u_b, double u_in, double lambda, double dx) {
+        switch (bc.type) {
+            case BoundaryType::DIRICHLET:
+                return lambda * (u_in - u_b) / dx;
+            case BoundaryType::ROBIN:
+                return lambda * bc.coefficient * (u_b - (bc.value + KELVIN_OFFSET));
+            case BoundaryType::NEUMANN:
+            case BoundaryType::PERIODIC:
+                break;
+        }
+        return 0.0;
+    }
+
+}
@@ -0,0 +1,43 @@
+#ifndef FIELD_STATS_HPP
+#define FIELD_STATS_HPP
+
+#include "boundary_conditions.hpp"
+
+namespace ensiie {
+
+    /**
+     * @struct FieldStats
+     * @brief Summary of the field after a step, computed by the solver
+     *
+     * Temperatures are in Kelvin. Integrals are per unit cross-section
+     * for a bar (d = 1) and per unit thickness for a plate (d = 2), with
+     * every grid point weighted by Δx^d.
+     */
+    struct FieldStats {
+        double min = 0.0;           ///< Lowest temperature
+        double max = 0.0;           ///< Highest temperature
+        double mean = 0.0;          ///< Average over the grid points
+        double l2 = 0.0;            ///< sqrt(Σ u² Δx^d)
+        double energy = 0.0;        ///< Heat stored since the initial state ρc Σ (u - u0) Δx^d, J/m^(3-d)
+        double boundary_flux = 0.0; ///< Heat leaving through the boundaries, W/m^(3-d)
+        double delta = 0.0;         ///< max |u^{n+1} - u^n| of the last step, 0 before the first one
+    };
+
+    /**
+     * @brief Outward heat flux density through one boundary point, -λ du/dn
+     *
+     * Zero for insulated and periodic sides, the exchange h (u_b - u_ext)
+     * for Robin, and the one-sided difference λ (u_in - u_b) / Δx on a
+     * fixed temperature.
+     * @param bc Condition of the side
+     * @param u_b Temperature of the boundary point (K)
+     * @param u_in Temperature of its inner neighbour (K)
+     * @param lambda Thermal conductivity W/(mK)
+     * @param dx Spatial step
+     * @return Flux in W/m²
+     */
+    double outward_flux(const BoundaryCondition& bc, double u_b, double u_in, double lambda, double dx);
+
+}
+
+#endif
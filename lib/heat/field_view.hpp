@@ -0,0 +1,57 @@
+#ifndef FIELD_VIEW_HPP
+#define FIELD_VIEW_HPP
+
+#include <vector>
+
+namespace ensiie {
+
+    /**
+     * @struct FieldView
+     * @brief Read-only strided view of a temperature field, like mdspan
+     *
+     * Point (i, j) is data[j * stride + i], with i along x and j along y.
+     * A bar is one row (ny = 1). The view does not own the values: it is
+     * valid as long as the field it was taken from is neither resized nor
+     * destroyed, and it sees every later write to it.
+     */
+    struct FieldView {
+        const double* data = nullptr;   ///< Point (0, 0)
+        int nx = 0;                     ///< Points per row
+        int ny = 0;                     ///< Number of rows
+        int stride = 0;                 ///< Distance between two rows, in values
+
+        FieldView() = default;
+
+        FieldView(const double* data, int nx, int ny, int stride)
+            : data(data)
+            , nx(nx)
+            , ny(ny)
+            , stride(stride) {
+        }
+
+        /**
+         * @brief View a row-major field of ny rows of nx values
+         */
+        FieldView(const std::vector<double>& values, int nx, int ny)
+            : FieldView(values.data(), nx, ny, nx) {
+        }
+
+        double operator()(int i, int j) const { return data[j * stride + i]; }
+
+        /**
+         * @brief Get the nx contiguous values of row j
+         */
+        const double* row(int j) const { return data + j * stride; }
+
+        /**
+         * @brief Check that rows follow each other without gap
+         */
+        bool contiguous() const { return stride == nx || ny <= 1; }
+
+        bool empty() const { return nx == 0 || ny == 0; }
+        int size() const { return nx * ny; }
+    };
+
+}
+
+#endif
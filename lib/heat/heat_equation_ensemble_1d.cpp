@@ -0,0 +1,253 @@
+#include "heat_equation_ensemble_1d.hpp"
+#include "stencil_kernels.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/// Celsius to Kelvin conversion
+constexpr double KELVIN_OFFSET = 273.15;
+
+namespace ensiie {
+
+    HeatEquationEnsemble1D::HeatEquationEnsemble1D(const std::vector<BarSpec>& bars, double L, double tmax, int n)
+    : bars_(bars)
+    , L_(L)
+    , tmax_(tmax)
+    , dx_(L / (n - 1))
+    , dt_(tmax / 1000.0)  // 1001 time points, as the single bar
+    , t_(0.0)
+    , n_(n)
+    , lanes_((static_cast<int>(bars.size()) + LANE_MULTIPLE - 1) / LANE_MULTIPLE * LANE_MULTIPLE)
+    , stats_(bars.size())
+    , steady_(bars.size())
+    {
+        if (bars.empty() || n < 3) {
+            throw std::invalid_argument("HeatEquationEnsemble1D: needs at least one bar of 3 points");
+        }
+
+        const std::size_t size = static_cast<std::size_t>(n_) * lanes_;
+        u_.assign(size, 0.0);
+        prev_.assign(size, 0.0);
+        src_.assign(size, 0.0);
+        a_.assign(size, 0.0);
+        c_prime_.assign(size, 0.0);
+        inv_pivot_.assign(size, 1.0);
+        rhs_left_.assign(lanes_, 0.0);
+        rhs_right_.assign(lanes_, 0.0);
+
+        for (const BarSpec& bar : bars_) {
+            left_.push_back(BoundaryCondition::neumann());
+            right_.push_back(BoundaryCondition::dirichlet(bar.u0));
+        }
+
+        factorize();
+        init_fields();
+    }
+
+    void HeatEquationEnsemble1D::factorize()
+    {
+        std::vector<double> a(n_);
+        std::vector<double> b(n_);
+        std::vector<double> c(n_);
+
+        for (int bar = 0; bar < size(); bar++) {
+            const Material& mat = bars_[bar].material;
+            double r    = mat.alpha() * dt_ / (dx_ * dx_);
+            double coef = dt_ / (mat.rho * mat.c);
+
+            // -r*u[i-1] + (1+2r)*u[i] - r*u[i+1] = u[i]^n + Δt/(ρc)*F[i], as the single bar
+            std::fill(a.begin(), a.end(), -r);
+            std::fill(b.begin(), b.end(), 1.0 + 2.0 * r);
+            std::fill(c.begin(), c.end(), -r);
+            boundary::visit(left_[bar].type, [&](auto side) {
+                boundary::bar_row<decltype(side)>(left_[bar], dx_, left_[bar].value + KELVIN_OFFSET
+                                                  , b[0], c[0], rhs_left_[bar]);
+            });
+            boundary::visit(right_[bar].type, [&](auto side) {
+                boundary::bar_row<decltype(side)>(right_[bar], dx_, right_[bar].value + KELVIN_OFFSET
+                                                  , b[n_ - 1], a[n_ - 1], rhs_right_[bar]);
+            });
+            c[n_ - 1] = 0.0;
+
+            // Forward elimination of the matrix, into lane bar
+            double c_prev = 0.0;
+            for (int i = 0; i < n_; i++) {
+                std::size_t k = static_cast<std::size_t>(i) * lanes_ + bar;
+                double inv = 1.0 / (b[i] - (i > 0 ? a[i] * c_prev : 0.0));
+                a_[k] = a[i];
+                inv_pivot_[k] = inv;
+                c_prime_[k] = c_prev = c[i] * inv;
+            }
+
+            // Source F(x) = tmax*f^2 on [L/10, 2L/10], (3/4)*tmax*f^2 on [5L/10, 6L/10]
+            double f = bars_[bar].f;
+            double f1 = tmax_ * f * f;
+            double f2 = 0.75 * tmax_ * f * f;
+            for (int i = 1; i < n_ - 1; i++) {
+                double x = i * dx_;
+                double F = 0.0;
+                if (x >= L_ / 10.0 && x <= 2 * L_ / 10.0) {
+                    F = f1;
+                } else if (x >= 5.0 * L_ / 10.0 && x <= 6.0 * L_ / 10.0) {
+                    F = f2;
+                }
+                src_[static_cast<std::size_t>(i) * lanes_ + bar] = coef * F;
+            }
+        }
+    }
+
+    void HeatEquationEnsemble1D::init_fields()
+    {
+        for (int bar = 0; bar < size(); bar++) {
+            double u0 = bars_[bar].u0 + KELVIN_OFFSET;
+            for (int i = 0; i < n_; i++) {
+                u_[static_cast<std::size_t>(i) * lanes_ + bar] = u0;
+            }
+            if (left_[bar].type == BoundaryType::DIRICHLET) {
+                u_[bar] = left_[bar].value + KELVIN_OFFSET;
+            }
+            if (right_[bar].type == BoundaryType::DIRICHLET) {
+                u_[static_cast<std::size_t>(n_ - 1) * lanes_ + bar] = right_[bar].value + KELVIN_OFFSET;
+            }
+        }
+        prev_ = u_;
+        update_stats();
+    }
+
+    bool HeatEquationEnsemble1D::step()
+    {
+        return advance(1) > 0;
+    }
+
+    int HeatEquationEnsemble1D::advance(int steps, double until)
+    {
+        TraceSpan span("advance", "solver");
+        span.arg("bars", size());
+        until = std::min(until, tmax_);
+
+        // Same count as calling step(), t_ accumulating the same way
+        int count = 0;
+        double t = t_;
+        while (count < steps && t < until) {
+            t += dt_;
+            count++;
+        }
+
+        // Only the last two steps need statistics, for the steady states
+        for (int k = 0; k < count; k++) {
+            if (k == count - 2 && k > 0) {
+                std::copy(u_.begin(), u_.end(), prev_.begin());
+            }
+            solve_step();
+            t_ += dt_;
+            if (k >= count - 2) {
+                update_stats();
+                for (int bar = 0; bar < size(); bar++) {
+                    steady_[bar].update(stats_[bar].delta, dt_, t_);
+                }
+            }
+        }
+
+        span.arg("steps", count);
+        return count;
+    }
+
+    int HeatEquationEnsemble1D::advance_to(double t)
+    {
+        return advance(std::numeric_limits<int>::max(), t);
+    }
+
+    void HeatEquationEnsemble1D::solve_step()
+    {
+        // Boundary rows of every lane, the sources being 0 there
+        double* last = u_.data() + static_cast<std::size_t>(n_ - 1) * lanes_;
+        std::copy(rhs_left_.begin(), rhs_left_.end(), u_.begin());
+        std::copy(rhs_right_.begin(), rhs_right_.end(), last);
+
+        stencil_kernels().thomas_lanes(u_.data(), src_.data(), a_.data(), c_prime_.data()
+                                       , inv_pivot_.data(), n_, lanes_);
+    }
+
+    void HeatEquationEnsemble1D::update_stats()
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        std::vector<double> lo(lanes_, inf);
+        std::vector<double> hi(lanes_, -inf);
+        std::vector<double> sum(lanes_, 0.0);
+        std::vector<double> sum_sq(lanes_, 0.0);
+        std::vector<double> delta(lanes_, 0.0);
+
+        // Lanes innermost, as the fields are laid out
+        for (int i = 0; i < n_; i++) {
+            double* row = u_.data() + static_cast<std::size_t>(i) * lanes_;
+            double* prev = prev_.data() + static_cast<std::size_t>(i) * lanes_;
+            for (int l = 0; l < lanes_; l++) {
+                double v = row[l];
+                lo[l] = std::min(lo[l], v);
+                hi[l] = std::max(hi[l], v);
+                sum[l] += v;
+                sum_sq[l] += v * v;
+                delta[l] = std::max(delta[l], std::abs(v - prev[l]));
+                prev[l] = v;
+            }
+        }
+
+        for (int bar = 0; bar < size(); bar++) {
+            const Material& mat = bars_[bar].material;
+            double u0 = bars_[bar].u0 + KELVIN_OFFSET;
+            FieldStats& stats = stats_[bar];
+            stats.min = lo[bar];
+            stats.max = hi[bar];
+            stats.mean = sum[bar] / n_;
+            stats.l2 = std::sqrt(sum_sq[bar] * dx_);
+            stats.energy = mat.rho * mat.c * (sum[bar] - n_ * u0) * dx_;
+            stats.boundary_flux = outward_flux(left_[bar], get_temperature(bar, 0), get_temperature(bar, 1)
+                                               , mat.lambda, dx_)
+                                + outward_flux(right_[bar], get_temperature(bar, n_ - 1), get_temperature(bar, n_ - 2)
+                                               , mat.lambda, dx_);
+            stats.delta = delta[bar];
+        }
+    }
+
+    std::vector<double> HeatEquationEnsemble1D::get_temperature(int bar) const
+    {
+        std::vector<double> temps(n_);
+        for (int i = 0; i < n_; i++) {
+            temps[i] = get_temperature(bar, i);
+        }
+        return temps;
+    }
+
+    void HeatEquationEnsemble1D::set_boundaries(const BoundaryCondition& left, const BoundaryCondition& right)
+    {
+        if (left.type == BoundaryType::PERIODIC || right.type == BoundaryType::PERIODIC) {
+            throw std::invalid_argument("HeatEquationEnsemble1D: periodic bars are not supported");
+        }
+
+        std::fill(left_.begin(), left_.end(), left);
+        std::fill(right_.begin(), right_.end(), right);
+        for (SteadyStateMonitor& monitor : steady_) {
+            monitor.reset();
+        }
+        factorize();
+        for (int bar = 0; bar < size(); bar++) {
+            if (left.type == BoundaryType::DIRICHLET) {
+                u_[bar] = left.value + KELVIN_OFFSET;
+            }
+            if (right.type == BoundaryType::DIRICHLET) {
+                u_[static_cast<std::size_t>(n_ - 1) * lanes_ + bar] = right.value + KELVIN_OFFSET;
+            }
+        }
+        update_stats();
+    }
+
+    void HeatEquationEnsemble1D::reset()
+    {
+        t_ = 0.0;
+        for (SteadyStateMonitor& monitor : steady_) {
+            monitor.reset();
+        }
+        init_fields();
+    }
+}
@@ -0,0 +1,179 @@
+#ifndef HEAT_EQUATION_ENSEMBLE_1D_HPP
+#define HEAT_EQUATION_ENSEMBLE_1D_HPP
+
+#include "boundary_conditions.hpp"
+#include "field_stats.hpp"
+#include "material.hpp"
+#include "steady_state.hpp"
+#include <limits>
+#include <vector>
+
+namespace ensiie {
+
+    /**
+     * @struct BarSpec
+     * @brief Parameters of one bar of an ensemble
+     */
+    struct BarSpec {
+        Material material;      ///< Material of the bar
+        double u0;              ///< Initial temperature (Celsius)
+        double f;               ///< Heat source amplitude (Celsius)
+    };
+
+    /**
+     * @class HeatEquationEnsemble1D
+     * @brief Many bars of the same grid stepped together in SIMD lanes
+     *
+     * Each bar is the problem of HeatEquationSolver1D, with its own
+     * material, initial temperature and source, on a grid and a time
+     * step shared by all. Fields, sources and factors are interleaved:
+     * point i of bar b is at i*lanes + b, lanes being the number of bars
+     * rounded up to 8. One Thomas substitution then advances every bar,
+     * a vector holding the same point of several bars, so the serial
+     * recurrence of one bar is replaced by independent ones side by
+     * side. The fields are those of separate solvers, up to rounding.
+     *
+     * Bars default to Neumann at x=0 and Dirichlet at their own u0 at
+     * x=L. There is no adaptive stepping or profiling.
+     */
+    class HeatEquationEnsemble1D
+    {
+        public:
+            static constexpr int LANE_MULTIPLE = 8;    ///< Widest vector, in doubles
+
+        private:
+            std::vector<BarSpec> bars_; ///< Parameters of each bar
+            double L_;                  ///< Bar length
+            double tmax_;               ///< Max simulation time
+            double dx_;                 ///< Spatial step
+            double dt_;                 ///< Time step
+            double t_;                  ///< Current time
+            int n_;                     ///< Number of spatial points
+            int lanes_;                 ///< Bars rounded up to LANE_MULTIPLE, padding lanes staying at 0
+
+            std::vector<double> u_;         ///< Temperature fields, interleaved
+            std::vector<double> prev_;      ///< Fields before the last step, for FieldStats::delta
+            std::vector<double> src_;       ///< Source per step Δt/(ρc)*F, 0 on boundary rows
+            std::vector<double> a_;         ///< Lower diagonals
+            std::vector<double> c_prime_;   ///< Eliminated upper diagonals
+            std::vector<double> inv_pivot_; ///< Inverse of the eliminated pivots
+            std::vector<double> rhs_left_;  ///< RHS of the x=0 boundary row, per lane
+            std::vector<double> rhs_right_; ///< RHS of the x=L boundary row, per lane
+
+            std::vector<BoundaryCondition> left_;   ///< Condition at x=0 of each bar
+            std::vector<BoundaryCondition> right_;  ///< Condition at x=L of each bar
+            std::vector<FieldStats> stats_;         ///< Statistics of each field
+            std::vector<SteadyStateMonitor> steady_; ///< Rate of change of each bar
+
+            /**
+             * @brief Build and eliminate the implicit matrix of every bar
+             */
+            void factorize();
+
+            /**
+             * @brief Set the fields to the initial temperatures and the Dirichlet values
+             */
+            void init_fields();
+
+            /**
+             * @brief Compute stats_ of every bar in one pass over u_ and prev_, then set prev_ to u_
+             */
+            void update_stats();
+
+            /**
+             * @brief Advance every field by one step, without statistics
+             */
+            void solve_step();
+
+        public:
+            /**
+             * @brief Constructor
+             * @param bars Material, initial temperature and source of each bar
+             * @param L Length of every bar (m)
+             * @param tmax Maximum simulation time (s), steps of tmax/1000
+             * @param n Number of spatial points of every bar
+             * @throws std::invalid_argument if there is no bar or n < 3
+             */
+            HeatEquationEnsemble1D(const std::vector<BarSpec>& bars, double L, double tmax, int n);
+
+            /**
+             * @brief Advance every bar by one time step
+             * @return true if simulation continues, false if finished
+             */
+            bool step();
+
+            /**
+             * @brief Take up to steps time steps in one call
+             *
+             * The substitutions run back to back, the statistics and steady
+             * states only being updated by the last two.
+             * @param steps Steps at most
+             * @param until Steps are taken while the time is below, at most tmax
+             * @return Steps taken, fewer than steps once tmax or until is reached
+             */
+            int advance(int steps, double until = std::numeric_limits<double>::infinity());
+
+            /**
+             * @brief Take steps until the time reaches t, as advance()
+             * @param t Target time, clamped to tmax
+             * @return Steps taken
+             */
+            int advance_to(double t);
+
+            /**
+             * @brief Get the temperature of one bar
+             * @param bar Index of the bar, as given to the constructor
+             * @return Vector of temperature in Kelvin, copied out of the lanes
+             */
+            std::vector<double> get_temperature(int bar) const;
+
+            /**
+             * @brief Get the temperature of one bar at one point, in Kelvin
+             */
+            double get_temperature(int bar, int i) const { return u_[static_cast<std::size_t>(i) * lanes_ + bar]; }
+
+            /**
+             * @brief Get the statistics of one bar, updated by every step
+             */
+            const FieldStats& get_stats(int bar) const { return stats_[bar]; }
+
+            /**
+             * @brief Get the rate of change and equilibrium estimate of one bar
+             */
+            const SteadyState& get_steady_state(int bar) const { return steady_[bar].get_state(); }
+
+            /**
+             * @brief Set the conditions at both ends of every bar
+             * @throws std::invalid_argument for periodic conditions, not supported
+             */
+            void set_boundaries(const BoundaryCondition& left, const BoundaryCondition& right);
+
+            /**
+             * @brief Get the parameters of one bar
+             */
+            const BarSpec& get_bar(int bar) const { return bars_[bar]; }
+
+            /**
+             * @brief Get the number of bars
+             */
+            int size() const { return static_cast<int>(bars_.size()); }
+
+            /**
+             * @brief Get current simulation time
+             * @return Time in seconds
+             */
+            double get_time() const { return t_; }
+
+            /**
+             * @brief Get number of spatial points per bar
+             */
+            int get_n() const { return n_; }
+
+            /**
+             * @brief Reset every bar to its initial state
+             */
+            void reset();
+    };
+}
+
+#endif
@@ -1,9 +1,17 @@
 #include "heat_equation_solver_1d.hpp"
+#include "stencil_kernels.hpp"
+#include "trace.hpp"
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
 
 /// Celsius to Kelvin conversion
 constexpr double KELVIN_OFFSET = 273.15;
 
+/// Inverse iterations for the slowest mode of the bar
+constexpr int STEADY_INVERSE_ITERATIONS = 30;
+
 namespace ensiie {
     HeatEquationSolver1D::HeatEquationSolver1D(
         const Material& mat
@@ -20,11 +28,25 @@ namespace ensiie {
     , dt_(tmax / 1000.0)  // 1001 time points
     , u0_kelvin_(u0 + KELVIN_OFFSET)
     , t_(0.0)
+    , steps_(0)
     , n_(n)
     , u_(n, u0_kelvin_)
     , F_(n, 0.0)
+    , src_(n, 0.0)
+    , prev_(n, u0_kelvin_)
+    , profiling_(false)
+    , adaptive_(false)
+    , control_(tmax / 1000.0)
+    , steady_stop_(false)
+    , threads_(0)
+    , left_(BoundaryCondition::neumann())
+    , right_(BoundaryCondition::dirichlet(u0))
+    , rhs_left_(0.0)
+    , rhs_right_(u0_kelvin_)
     {
         init_source(f);
+        factorize();
+        update_stats();
     }
 
     void HeatEquationSolver1D::init_source(double f) {
@@ -51,18 +73,12 @@ namespace ensiie {
         }
     }
 
-    bool HeatEquationSolver1D::step() 
+    void HeatEquationSolver1D::factorize()
     {
-        // Check if simulation is done
-        if (t_ >= tmax_) {
-            return false;
-        }
-
         // Thermal diffusion alpha = lambda / (rho * c)
         double alpha = mat_.alpha();
 
         // Rate condutivity r = alpha * delta_t / (delta_x^2)
-
         double r     = alpha * dt_ / (dx_ * dx_);
 
         // Coefficient
@@ -79,80 +95,327 @@ namespace ensiie {
         std::vector<double> a(n_, -r);
         std::vector<double> b(n_, 1.0 + 2.0 * r);
         std::vector<double> c(n_, -r);
-        std::vector<double> d(n_);
 
-        // RHS: d[i] = u[i]^n + delta_t/(rho * c) * F[i]
+        // A bar long enough is split over the pool, built on first need
+        if (!pool_ && threads_ != 1 && n_ >= 2 * TridiagonalSolver::MIN_BLOCK_ROWS) {
+            pool_ = std::make_unique<ThreadPool>(threads_);
+        }
+        tridiag_.set_pool(pool_.get());
+
+        if (left_.type == BoundaryType::PERIODIC) {
+            // u[n-1] is u[0]: n-1 unknowns, coupled through the corners
+            a.resize(n_ - 1);
+            b.resize(n_ - 1);
+            c.resize(n_ - 1);
+            tridiag_.factorize_cyclic(a, b, c);
+        } else {
+            // Boundary conditions, resolved at compile time per side
+            boundary::visit(left_.type, [&](auto side) {
+                boundary::bar_row<decltype(side)>(left_, dx_, left_.value + KELVIN_OFFSET, b[0], c[0], rhs_left_);
+            });
+            boundary::visit(right_.type, [&](auto side) {
+                boundary::bar_row<decltype(side)>(right_, dx_, right_.value + KELVIN_OFFSET, b[n_ - 1], a[n_ - 1], rhs_right_);
+            });
+            c[n_ - 1] = 0.0;
+
+            tridiag_.factorize(a, b, c);
+        }
+
+        // Source part of the RHS is constant too, none on the boundary rows
         for (int i = 0; i < n_; i++) {
-            d[i] = u_[i] + coef * F_[i];
+            src_[i] = coef * F_[i];
+        }
+        if (left_.type != BoundaryType::PERIODIC) {
+            src_[0]      = 0.0;
+            src_[n_ - 1] = 0.0;
+        }
+    }
+
+    bool HeatEquationSolver1D::step() 
+    {
+        // Check if simulation is done
+        if (finished()) {
+            return false;
+        }
+        take_step(tmax_);
+        return true;
+    }
+
+    int HeatEquationSolver1D::advance(int steps, double until)
+    {
+        TraceSpan span("advance", "solver");
+        until = std::min(until, tmax_);
+        int count = 0;
+
+        if (profiling_ || adaptive_ || steady_stop_) {
+            // Each step needs its statistics: timings, error or rate
+            while (count < steps && t_ < until && !finished()) {
+                take_step(until);
+                count++;
+            }
+            span.arg("steps", count);
+            return count;
         }
 
-        // Boundary conditions
+        // Same count as calling step(), t_ accumulating the same way
+        double t = t_;
+        while (count < steps && t < until) {
+            t += dt_;
+            count++;
+        }
+
+        // Back to back substitutions, the field, source and factors stay
+        // in cache; only the last two steps need statistics, for the rate
+        // and decay of the steady state
+        for (int k = 0; k < count; k++) {
+            if (k == count - 2 && k > 0) {
+                std::copy(u_.begin(), u_.end(), prev_.begin());
+            }
+            solve_step();
+            t_ += dt_;
+            if (k >= count - 2) {
+                update_stats();
+                steady_.update(stats_.delta, dt_, t_);
+            }
+        }
+        steps_ += count;
 
-        /// Neumann conditions
-        b[0] = 1.0;
-        c[0] = -1.0;
-        d[0] = 0.0;
+        span.arg("steps", count);
+        return count;
+    }
 
+    int HeatEquationSolver1D::advance_to(double t)
+    {
+        return advance(std::numeric_limits<int>::max(), t);
+    }
 
-        /// Dirchlet conditions
-        b[n_ - 1] = 1.0;
-        a[n_ - 1] = 0.0;
-        c[n_ - 1] = 0.0;
-        d[n_ - 1] = u0_kelvin_;
+    bool HeatEquationSolver1D::finished() const
+    {
+        return t_ >= tmax_ || (steady_stop_ && steady_.get_state().reached);
+    }
+
+    void HeatEquationSolver1D::take_step(double until)
+    {
+        TraceSpan span("step", "solver");
+        span.arg("step", static_cast<double>(steps_));
+
+        StepRecord record;
+        double dt = dt_;
+        {
+            ScopedTimer timer(profiling_ ? &record.at(StepPhase::SOLVE) : nullptr);
+            if (adaptive_) {
+                dt = adaptive_step(until);
+                span.arg("dt", dt);
+            } else {
+                solve_step();
+            }
+        }
 
-        // Solve equation
-        std::vector<double> u_sol(n_);
-        solve_tridiagonal(a, b, c, d, u_sol);
+        {
+            ScopedTimer timer(profiling_ ? &record.at(StepPhase::STATS) : nullptr);
+            update_stats();
+        }
 
-        // update solution
-        u_ = u_sol;
+        if (profiling_) {
+            profile_.add(record);
+        }
 
         // indexing tiume
-        t_ += dt_;
+        t_ += dt;
+        steps_++;
+        steady_.update(stats_.delta, dt, t_);
+    }
 
-        return true;
+    void HeatEquationSolver1D::solve_step()
+    {
+        // Substitution only on the RHS d[i] = u[i]^n + delta_t/(rho * c) * F[i],
+        // the source being added by the forward pass; u_ now holds u^{n+1}
+        if (left_.type == BoundaryType::PERIODIC) {
+            tridiag_.solve(u_.data(), src_.data());
+            u_[n_ - 1] = u_[0];
+        } else {
+            // Boundary rows, by default Neumann u[0] - u[1] = 0, Dirichlet u[n-1] = u0
+            u_[0]      = rhs_left_;
+            u_[n_ - 1] = rhs_right_;
+            tridiag_.solve(u_.data(), src_.data());
+        }
+    }
+
+    double HeatEquationSolver1D::adaptive_step(double until)
+    {
+        // prev_ holds the field at the start of the step until update_stats()
+        while (true) {
+            double h = std::min(control_.step_size(), until - t_);
+
+            set_dt(h);
+            solve_step();
+            full_ = u_;
+
+            std::copy(prev_.begin(), prev_.end(), u_.begin());
+            set_dt(0.5 * h);
+            solve_step();
+            solve_step();
+
+            double difference = 0.0;
+            for (int i = 0; i < n_; i++) {
+                difference = std::max(difference, std::abs(u_[i] - full_[i]));
+            }
+            if (control_.update(difference, 1, h)) {
+                return h;
+            }
+            std::copy(prev_.begin(), prev_.end(), u_.begin());
+        }
     }
 
+    void HeatEquationSolver1D::set_dt(double dt)
+    {
+        if (dt != dt_) {
+            dt_ = dt;
+            factorize();
+        }
+    }
 
-    void HeatEquationSolver1D::solve_tridiagonal(
-        const std::vector<double>& a
-        , const std::vector<double>& b
-        , const std::vector<double>& c
-        , std::vector<double>& d
-        , std::vector<double>& x 
-    ) {
-        // Thomas algorithm (TDMA - TriDiagonal Matrix Algorithm)
-        // Solves: a[i]*x[i-1] + b[i]*x[i] + c[i]*x[i+1] = d[i]
+    void HeatEquationSolver1D::solve_steady()
+    {
+        auto anchors = [](const BoundaryCondition& bc) {
+            return bc.type == BoundaryType::DIRICHLET || (bc.type == BoundaryType::ROBIN && bc.coefficient > 0.0);
+        };
+        if (!anchors(left_) && !anchors(right_)) {
+            throw std::logic_error("HeatEquationSolver1D: no equilibrium without a Dirichlet or Robin end");
+        }
 
-        int n = static_cast<int>(b.size());
+        // -u[i-1] + 2u[i] - u[i+1] = Δx²/λ F[i], boundary rows as in the steps
+        std::vector<double> a(n_, -1.0);
+        std::vector<double> b(n_, 2.0);
+        std::vector<double> c(n_, -1.0);
+        double rhs_left = 0.0;
+        double rhs_right = 0.0;
+        boundary::visit(left_.type, [&](auto side) {
+            boundary::bar_row<decltype(side)>(left_, dx_, left_.value + KELVIN_OFFSET, b[0], c[0], rhs_left);
+        });
+        boundary::visit(right_.type, [&](auto side) {
+            boundary::bar_row<decltype(side)>(right_, dx_, right_.value + KELVIN_OFFSET, b[n_ - 1], a[n_ - 1], rhs_right);
+        });
+        c[n_ - 1] = 0.0;
 
-        // Temp array forward
-        std::vector<double> c_prime(n);
-        std::vector<double> d_prime(n);
+        TridiagonalSolver stationary;
+        stationary.set_pool(pool_.get());
+        stationary.factorize(a, b, c);
 
-        // Forward
-        c_prime[0] = c[0] / b[0];
-        d_prime[0] = d[0] / b[0];
+        std::vector<double> eq(n_);
+        for (int i = 0; i < n_; i++) {
+            eq[i] = dx_ * dx_ / mat_.lambda * F_[i];
+        }
+        eq[0]      = rhs_left;
+        eq[n_ - 1] = rhs_right;
+        stationary.solve(eq);
 
-        // Iterate over spatial points
-        for (int i = 1; i < n; i++)
-        {
-            double denom = b[i] - a[i] * c_prime[i - 1];
-            c_prime[i]   = c[i] / denom;
-            d_prime[i]   = (d[i] - a[i] * d_prime[i - 1]) / denom;
+        // Slowest mode by inverse iteration on the inner points, the
+        // boundary rows being constraints with no source
+        std::vector<double> mode(n_, 1.0);
+        double mu = 0.0;
+        for (int k = 0; k < STEADY_INVERSE_ITERATIONS; k++) {
+            mode[0] = 0.0;
+            mode[n_ - 1] = 0.0;
+            double before = 0.0;
+            for (int i = 1; i < n_ - 1; i++) {
+                before += mode[i] * mode[i];
+            }
+            stationary.solve(mode);
+            double after = 0.0;
+            for (int i = 1; i < n_ - 1; i++) {
+                after += mode[i] * mode[i];
+            }
+            mu = std::sqrt(before / after);
+            for (double& v : mode) {
+                v /= std::sqrt(after);
+            }
+        }
+
+        u_ = eq;
+        update_stats();
+        steady_.solved(stats_.delta, mat_.alpha() / (dx_ * dx_) * mu, t_);
+    }
+
+    void HeatEquationSolver1D::set_steady_stop(bool enabled, double tolerance)
+    {
+        steady_.set_tolerance(tolerance);
+        steady_stop_ = enabled;
+    }
+
+    void HeatEquationSolver1D::set_adaptive(bool enabled, const AdaptiveOptions& options)
+    {
+        control_.configure(options);
+        adaptive_ = enabled;
+        if (!adaptive_) {
+            set_dt(control_.get_base_dt());
+        }
+    }
+
+    void HeatEquationSolver1D::set_boundaries(const BoundaryCondition& left, const BoundaryCondition& right)
+    {
+        if ((left.type == BoundaryType::PERIODIC) != (right.type == BoundaryType::PERIODIC)) {
+            throw std::invalid_argument("HeatEquationSolver1D: periodic conditions must be set on both ends");
         }
 
-        // Back sub
-        x[n-1]  = d_prime[n-1];
+        left_  = left;
+        right_ = right;
+        steady_.reset();
+        factorize();
+        apply_fixed_values();
+        update_stats();
+    }
 
-        for (int i = n - 2; i >= 0; --i) {
-            x[i] = d_prime[i] - c_prime[i] * x[i+1];
+    void HeatEquationSolver1D::apply_fixed_values()
+    {
+        if (left_.type == BoundaryType::DIRICHLET) {
+            u_[0] = left_.value + KELVIN_OFFSET;
         }
+        if (right_.type == BoundaryType::DIRICHLET) {
+            u_[n_ - 1] = right_.value + KELVIN_OFFSET;
+        }
+        if (left_.type == BoundaryType::PERIODIC) {
+            u_[n_ - 1] = u_[0];
+        }
+    }
+
+    void HeatEquationSolver1D::set_threads(int threads) {
+        threads_ = threads;
+        pool_.reset();
+        factorize();
     }
 
     void HeatEquationSolver1D::reset() {
         t_ = 0.0;
+        steps_ = 0;
+        control_.reset();
+        steady_.reset();
+        set_dt(control_.get_base_dt());
+        profile_ = StepProfile{};
         std::fill(u_.begin(), u_.end(), u0_kelvin_);
+        apply_fixed_values();
+        prev_ = u_;
+        update_stats();
+    }
+
+    void HeatEquationSolver1D::set_profiling(bool enabled) {
+        profiling_ = enabled;
+        profile_ = StepProfile{};
+    }
+
+    void HeatEquationSolver1D::update_stats() {
+        const double inf = std::numeric_limits<double>::infinity();
+        RowSummary total = {inf, -inf, 0.0, 0.0, 0.0};
+        stencil_kernels().summarize(u_.data(), prev_.data(), 0, n_, total);
+
+        stats_.min = total.min;
+        stats_.max = total.max;
+        stats_.mean = total.sum / n_;
+        stats_.l2 = std::sqrt(total.sum_sq * dx_);
+        stats_.energy = mat_.rho * mat_.c * (total.sum - n_ * u0_kelvin_) * dx_;
+        stats_.boundary_flux = outward_flux(left_, u_[0], u_[1], mat_.lambda, dx_)
+                             + outward_flux(right_, u_[n_ - 1], u_[n_ - 2], mat_.lambda, dx_);
+        stats_.delta = total.max_delta;
     }
 
 }
\ No newline at end of file
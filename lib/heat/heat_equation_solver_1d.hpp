@@ -1,7 +1,18 @@
 #ifndef HEAT_EQUATION_SOLVER_1D
 #define HEAT_EQUATION_SOLVER_1D
 
+#include "boundary_conditions.hpp"
+#include "field_stats.hpp"
+#include "field_view.hpp"
 #include "material.hpp"
+#include "steady_state.hpp"
+#include "step_control.hpp"
+#include "step_profile.hpp"
+#include "thread_pool.hpp"
+#include "tridiagonal_solver.hpp"
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <vector>
 
 namespace ensiie {
@@ -17,14 +28,34 @@ namespace ensiie {
             double L_;                  ///< Bar length
             double tmax_;               ///< Max simulation time
             double dx_;                 ///< Spatial step
-            double dt_;                 ///< Time step
+            double dt_;                 ///< Time step of the current factorization
             double u0_kelvin_;          ///< Initial temp in Kelvin
             double t_;                  ///< Current time
+            std::uint64_t steps_;       ///< Steps since the start
 
             int n_;                     ///< Number of spatial points
 
             std::vector<double> u_;     ///< Temperature field
             std::vector<double> F_;     ///< Heat source term
+            std::vector<double> src_;   ///< Source contribution per step Δt/(ρc)*F, 0 on boundary rows
+            std::vector<double> prev_;  ///< Field before the last step, for FieldStats::delta
+            FieldStats stats_;          ///< Statistics of the current field
+            bool profiling_;            ///< Time the steps into profile_
+            StepProfile profile_;       ///< Timings of the profiled steps
+            bool adaptive_;             ///< Step size chosen by control_
+            StepControl control_;       ///< Step doubling controller
+            std::vector<double> full_;  ///< Field after the full step of an attempt
+            SteadyStateMonitor steady_; ///< Rate of change and equilibrium estimate
+            bool steady_stop_;          ///< step() stops once steady_ is reached
+
+            TridiagonalSolver tridiag_; ///< Prefactored implicit matrix
+            int threads_;               ///< Threads of the partitioned solve, 0 for hardware concurrency
+            std::unique_ptr<ThreadPool> pool_;  ///< Workers of tridiag_, built once the bar is long enough to split
+
+            BoundaryCondition left_;    ///< Condition at x=0
+            BoundaryCondition right_;   ///< Condition at x=L
+            double rhs_left_;           ///< RHS of the x=0 boundary row
+            double rhs_right_;          ///< RHS of the x=L boundary row
 
             /**
              * @brief Initialize heat source F(x)
@@ -37,15 +68,55 @@ namespace ensiie {
             void init_source(double f);
 
             /**
-             * @brief Solve tridiagonal system (Thomas Algorithms)
+             * @brief Build and factorize the implicit matrix
+             *
+             * r, dt and dx are constant during a run, so the matrix is
+             * factorized once here and step() only does the substitution.
+             * Must be called again whenever dt, dx, the material or the
+             * boundary conditions change.
              */
-            void solve_tridiagonal(
-                const std::vector<double>& a
-                , const std::vector<double>& b
-                , const std::vector<double>& c
-                , std::vector<double>& d 
-                , std::vector<double>& x
-            );
+            void factorize();
+
+            /**
+             * @brief Set Dirichlet points to their value, and the periodic copy
+             */
+            void apply_fixed_values();
+
+            /**
+             * @brief Compute stats_ in one SIMD pass over u_ and prev_, then set prev_ to u_
+             */
+            void update_stats();
+
+            /**
+             * @brief Set the step size, refactorizing if it changed
+             */
+            void set_dt(double dt);
+
+            /**
+             * @brief Advance u_ by one step of dt_, without statistics
+             */
+            void solve_step();
+
+            /**
+             * @brief Advance u_ by one controlled step, from prev_
+             *
+             * Step doubling: one step of h and two of h/2, kept when they
+             * agree within the tolerance, else redone with a smaller h.
+             * @param until The step ends at this time at the latest
+             * @return Size of the step taken
+             */
+            double adaptive_step(double until);
+
+            /**
+             * @brief Check for tmax, or the steady state when it stops the run
+             */
+            bool finished() const;
+
+            /**
+             * @brief One step with its statistics, profile and steady state update
+             * @param until Time an adaptive step must not pass
+             */
+            void take_step(double until);
 
 
         public:
@@ -73,12 +144,130 @@ namespace ensiie {
              */
             bool step();
 
+            /**
+             * @brief Take up to steps time steps in one call
+             *
+             * Gives the field of as many step() calls. With fixed steps and
+             * neither profiling nor the steady stop, the substitutions run
+             * back to back, the source added by the forward pass, and the
+             * statistics and steady state are only updated by the last two.
+             * @param steps Steps at most
+             * @param until Steps are taken while the time is below, at most tmax
+             * @return Steps taken, fewer than steps once the run is finished or until is reached
+             */
+            int advance(int steps, double until = std::numeric_limits<double>::infinity());
+
+            /**
+             * @brief Take steps until the time reaches t, as advance()
+             *
+             * Fixed steps end on the first multiple of dt at or past t,
+             * adaptive ones are shortened to end on t.
+             * @param t Target time, clamped to tmax
+             * @return Steps taken
+             */
+            int advance_to(double t);
+
             /**
              * @brief Get current temperature distribution
              * @return Vector of temperature in Kelvin
              */
             const std::vector<double>& get_temperature() const { return u_; }
 
+            /**
+             * @brief Get a view of the temperature, one row of n points
+             * @return View in Kelvin, valid until the solver is destroyed
+             */
+            FieldView get_field() const { return FieldView(u_, n_, 1); }
+
+            /**
+             * @brief Get the statistics of the current field, updated by every step
+             */
+            const FieldStats& get_stats() const { return stats_; }
+
+            /**
+             * @brief Time the phases of every step, off by default; enabling clears the profile
+             */
+            void set_profiling(bool enabled);
+
+            /**
+             * @brief Check whether steps are profiled
+             */
+            bool is_profiling() const { return profiling_; }
+
+            /**
+             * @brief Get the timings of the profiled steps, a direct solve each
+             */
+            const StepProfile& get_profile() const { return profile_; }
+
+            /**
+             * @brief Stop the run once the field is steady, off by default
+             *
+             * The rate max |Δu|/Δt of every step is followed either way, for
+             * get_steady_state(). Enabled, step() returns false once it falls
+             * below the tolerance.
+             * @param tolerance Rate of a steady field, in K/s
+             * @throws std::invalid_argument unless tolerance > 0
+             */
+            void set_steady_stop(bool enabled, double tolerance = DEFAULT_STEADY_TOLERANCE);
+
+            /**
+             * @brief Check whether the field has reached its equilibrium
+             */
+            bool is_steady() const { return steady_.get_state().reached; }
+
+            /**
+             * @brief Get the last rate of change and the time-to-equilibrium estimate
+             */
+            const SteadyState& get_steady_state() const { return steady_.get_state(); }
+
+            /**
+             * @brief Replace the field with the equilibrium, in one direct solve
+             *
+             * Solves the stationary problem -λu'' = F with the boundary
+             * rows of the steps, a tridiagonal system. The time is left
+             * unchanged; the estimate of get_steady_state() is when the
+             * replaced field would have got there, from the slowest mode
+             * found by inverse iteration.
+             * @throws std::logic_error if no end is Dirichlet or Robin, there is no equilibrium
+             */
+            void solve_steady();
+
+            /**
+             * @brief Choose the step size by step doubling, off by default
+             *
+             * Off, every step is tmax/1000. On, steps are tmax/1000 times a
+             * power of two, small while the field changes fast and large
+             * once it settles; each costs three solves and, when its size
+             * changed, two factorizations. Restarts the controller.
+             * @throws std::invalid_argument on invalid options
+             */
+            void set_adaptive(bool enabled, const AdaptiveOptions& options = AdaptiveOptions());
+
+            /**
+             * @brief Check whether the step size is adaptive
+             */
+            bool is_adaptive() const { return adaptive_; }
+
+            /**
+             * @brief Get the size of the next step
+             */
+            double get_dt() const { return adaptive_ ? control_.step_size() : dt_; }
+
+            /**
+             * @brief Get the accepted and rejected steps of the adaptive run
+             */
+            const StepControl& get_step_control() const { return control_; }
+
+            /**
+             * @brief Set the number of threads of the implicit solve
+             *
+             * Bars of at least 2 * TridiagonalSolver::MIN_BLOCK_ROWS points
+             * are split into one block per thread, shorter ones keep the
+             * Thomas algorithm on the calling thread.
+             * @param threads Thread count, 0 for hardware concurrency
+             */
+            void set_threads(int threads);
+
             /**
              * @brief Get current simulation time 
              * @return Time in seconds
@@ -90,6 +279,25 @@ namespace ensiie {
              */
             int get_n() const { return n_; }
 
+            /**
+             * @brief Set the conditions at both ends and refactorize
+             *
+             * Defaults are Neumann at x=0 and Dirichlet at u0 at x=L. A
+             * periodic bar has u[n-1] = u[0] and is solved as a cyclic system.
+             * @throws std::invalid_argument if only one side is periodic
+             */
+            void set_boundaries(const BoundaryCondition& left, const BoundaryCondition& right);
+
+            /**
+             * @brief Get the condition at x=0
+             */
+            const BoundaryCondition& get_left_boundary() const { return left_; }
+
+            /**
+             * @brief Get the condition at x=L
+             */
+            const BoundaryCondition& get_right_boundary() const { return right_; }
+
 
             /**
              * @brief Reset simulation to initial state
@@ -1,12 +1,205 @@
 #include "heat_equation_solver_2d.hpp"
+#include "stencil_kernels.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 
 
 /// Celsius to Kelvin conversion
 constexpr double KELVIN_OFFSET = 273.15;
 
 namespace ensiie {
+    namespace {
+        /// Factors kept by the process-wide Cholesky cache
+        const std::size_t CHOLESKY_CACHE_SIZE = 4;
+
+        /// Grid size from which the statistics pass is split over the pool
+        const int PARALLEL_STATS_POINTS = 1 << 16;
+
+        struct CholeskyEntry {
+            int n;
+            double r;
+            std::shared_ptr<const BandedCholesky> factor;
+        };
+
+        /**
+         * @brief Factor W*A of the implicit system for u - u0
+         *
+         * Unknowns are the (n-1)² non Dirichlet points in row-major order,
+         * so the band is n-1. A is made symmetric by the control volume
+         * weights W (1/2 on the i=0 and j=0 lines), and its Dirichlet
+         * couplings vanish since the unknown is u - u0.
+         */
+        std::shared_ptr<const BandedCholesky> build_cholesky(int n, double r)
+        {
+            const int m = n - 1;
+            auto chol = std::make_shared<BandedCholesky>(m * m, m);
+
+            for (int j = 0; j < m; j++) {
+                double wj = (j == 0) ? 0.5 : 1.0;
+                for (int i = 0; i < m; i++) {
+                    double w = wj * ((i == 0) ? 0.5 : 1.0);
+                    int p = j * m + i;
+
+                    chol->at(p, p) = w * (1.0 + 4.0 * r);
+                    if (i > 0) {
+                        chol->at(p, p - 1) = -w * r;
+                    }
+                    if (j > 0) {
+                        chol->at(p, p - m) = -w * r;
+                    }
+                }
+            }
+
+            chol->factorize();
+            return chol;
+        }
+
+        /**
+         * @brief Get the factor for (n, r), built on a cache miss
+         *
+         * The least recently used factor is dropped past
+         * CHOLESKY_CACHE_SIZE entries. Solvers keep their own reference.
+         */
+        std::shared_ptr<const BandedCholesky> cached_cholesky(int n, double r)
+        {
+            static std::mutex mutex;
+            static std::vector<CholeskyEntry> cache;   // Most recently used last
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for (auto it = cache.begin(); it != cache.end(); ++it) {
+                if (it->n == n && it->r == r) {
+                    CholeskyEntry entry = *it;
+                    cache.erase(it);
+                    cache.push_back(entry);
+                    return entry.factor;
+                }
+            }
+
+            if (cache.size() >= CHOLESKY_CACHE_SIZE) {
+                cache.erase(cache.begin());
+            }
+            cache.push_back(CholeskyEntry{n, r, build_cholesky(n, r)});
+            return cache.back().factor;
+        }
+
+        /**
+         * @brief Neighbour rows and diagonal of the implicit system on one row
+         */
+        struct RowStencil {
+            const double* dn;   ///< Row below, mirrored or wrapped at y=0
+            const double* up;   ///< Row above, mirrored at y=L
+            double diag;        ///< 1 + 4r, plus the Robin term on a Robin row
+        };
+
+        /**
+         * @brief Stencil of row j from the y=0 and y=L conditions
+         * @param extra_bottom Robin diagonal term of the y=0 side, 0 otherwise
+         * @param extra_top Robin diagonal term of the y=L side, 0 otherwise
+         * @return false if the row is not an unknown: Dirichlet row, or
+         * last row of a periodic plate, which copies row 0
+         */
+        bool row_stencil(
+            int j, int n, const double* u, double r
+            , const BoundaryCondition& bottom, const BoundaryCondition& top
+            , double extra_bottom, double extra_top, RowStencil& s)
+        {
+            s.diag = 1.0 + 4.0 * r;
+
+            if (j == 0) {
+                if (bottom.type == BoundaryType::DIRICHLET) {
+                    return false;
+                }
+                s.diag += extra_bottom;
+            } else if (j == n - 1) {
+                if (top.type == BoundaryType::DIRICHLET || top.type == BoundaryType::PERIODIC) {
+                    return false;
+                }
+                s.diag += extra_top;
+            }
+
+            int j_dn = (j > 0) ? j - 1 : (bottom.type == BoundaryType::PERIODIC ? n - 2 : 1);
+            int j_up = (j < n - 1) ? j + 1 : n - 2;
+            s.dn = u + j_dn * n;
+            s.up = u + j_up * n;
+            return true;
+        }
+
+        /**
+         * @brief Lexicographic Gauss-Seidel pass over one row
+         *
+         * The x=0 and x=L columns are resolved at compile time, the
+         * interior loop has no boundary test.
+         * @param b RHS of the row
+         * @param extra_left Robin diagonal term of the x=0 side, 0 otherwise
+         * @param extra_right Robin diagonal term of the x=L side, 0 otherwise
+         * @return Max update of the row
+         */
+        template <class Left, class Right>
+        double gauss_seidel_row(
+            double* row, const double* b, const RowStencil& s, int n, double r
+            , double extra_left, double extra_right)
+        {
+            double max_diff = 0.0;
+
+            auto update = [&](int i, double u_left, double u_right, double diag) {
+                double old_val = row[i];
+                row[i] = (b[i] + r * (u_left + u_right + s.dn[i] + s.up[i])) / diag;
+                max_diff = std::max(max_diff, std::abs(row[i] - old_val));
+            };
+
+            // Ghost point at x=0 is the mirror of column 1, or wraps to n-2
+            if constexpr (!Left::fixed) {
+                update(0, Left::periodic ? row[n - 2] : row[1], row[1], s.diag + extra_left);
+                if constexpr (Left::periodic) {
+                    row[n - 1] = row[0];
+                }
+            }
+            for (int i = 1; i < n - 1; i++) {
+                update(i, row[i - 1], row[i + 1], s.diag);
+            }
+            if constexpr (!Right::fixed && !Right::periodic) {
+                update(n - 1, row[n - 2], row[n - 2], s.diag + extra_right);
+            }
+
+            return max_diff;
+        }
+
+        /**
+         * @brief End row of the ADI line operator I - (r/2)δ² for one side policy
+         *
+         * Flux sides eliminate the ghost point as the 5-point stencil does:
+         *   (1 + r + r Δx h/λ) u_b - r u_in = ... + r Δx h/λ u_ext
+         * @param half_r Half rate r/2
+         * @param diag Coefficient of u_b
+         * @param inner Coefficient of u_in
+         * @param rhs Dirichlet value, or Robin term added to the line RHS
+         */
+        template <class Side>
+        void line_boundary(
+            const BoundaryCondition& bc, double dx, double half_r
+            , double& diag, double& inner, double& rhs)
+        {
+            double value = bc.value + KELVIN_OFFSET;
+
+            if constexpr (Side::fixed) {
+                diag  = 1.0;
+                inner = 0.0;
+                rhs   = value;
+            } else {
+                double e = Side::exchange(bc, dx);
+                diag  = 1.0 + 2.0 * half_r + 2.0 * half_r * e;
+                inner = -2.0 * half_r;
+                rhs   = 2.0 * half_r * e * value;
+            }
+        }
+    }
+
     HeatEquationSolver2D::HeatEquationSolver2D(
         const Material& mat
         , double L
@@ -14,6 +207,7 @@ namespace ensiie {
         , double u0
         , double f
         , int n
+        , Method method
     )
     : mat_(mat)
     , L_(L)
@@ -22,11 +216,28 @@ namespace ensiie {
     , dt_(tmax / 1000.0)
     , u0_kelvin_(u0 + KELVIN_OFFSET)
     , t_(0.0)
+    , steps_(0)
     , n_(n)
     , u_(n * n, u0_kelvin_)
     , F_(n * n, 0.0)
+    , rhs_(n * n, 0.0)
+    , last_step_{0, 0.0}
+    , prev_(n * n, u0_kelvin_)
+    , profiling_(false)
+    , adaptive_(false)
+    , control_(tmax / 1000.0)
+    , steady_stop_(false)
+    , bc_{{BoundaryCondition::neumann(), BoundaryCondition::dirichlet(u0)
+           , BoundaryCondition::neumann(), BoundaryCondition::dirichlet(u0)}}
+    , method_(method)
+    , omega_(0.0)
+    , threads_(0)
+    , adi_ready_(false)
+    , spec_valid_(false)
+    , preconditioner_(ConjugateGradient2D::Preconditioner::MULTIGRID)
     {
-        init_source(f);   
+        init_source(f);
+        update_stats();
     }
 
     void HeatEquationSolver2D::init_source(
@@ -70,57 +281,902 @@ namespace ensiie {
         }
     }
 
+    double HeatEquationSolver2D::exchange_term(Side s, double r) const {
+        double e = 0.0;
+        boundary::visit(side(s).type, [&](auto policy) {
+            e = decltype(policy)::exchange(side(s), dx_);
+        });
+        return 2.0 * r * e;
+    }
+
+    void HeatEquationSolver2D::add_robin_terms(double r) {
+        const int n = n_;
+
+        for (int s = 0; s < 4; s++) {
+            const BoundaryCondition& bc = bc_[s];
+            if (bc.type != BoundaryType::ROBIN) {
+                continue;
+            }
+
+            // First point and stride of the side: columns for x, rows for y
+            Side where = static_cast<Side>(s);
+            int first  = (where == Side::RIGHT) ? idx(n - 1, 0) : (where == Side::TOP) ? idx(0, n - 1) : 0;
+            int stride = (where == Side::LEFT || where == Side::RIGHT) ? n : 1;
+
+            double term = exchange_term(where, r) * (bc.value + KELVIN_OFFSET);
+            for (int k = 0; k < n; k++) {
+                rhs_[first + k * stride] += term;
+            }
+        }
+    }
+
+    void HeatEquationSolver2D::apply_fixed_values() {
+        const int n = n_;
+        const BoundaryCondition& left   = side(Side::LEFT);
+        const BoundaryCondition& right  = side(Side::RIGHT);
+        const BoundaryCondition& bottom = side(Side::BOTTOM);
+        const BoundaryCondition& top    = side(Side::TOP);
+
+        for (int k = 0; k < n; k++) {
+            if (bottom.type == BoundaryType::DIRICHLET) {
+                u_[idx(k, 0)] = bottom.value + KELVIN_OFFSET;
+            }
+            if (top.type == BoundaryType::DIRICHLET) {
+                u_[idx(k, n - 1)] = top.value + KELVIN_OFFSET;
+            }
+            if (bottom.type == BoundaryType::PERIODIC) {
+                u_[idx(k, n - 1)] = u_[idx(k, 0)];
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            if (left.type == BoundaryType::DIRICHLET) {
+                u_[idx(0, k)] = left.value + KELVIN_OFFSET;
+            }
+            if (right.type == BoundaryType::DIRICHLET) {
+                u_[idx(n - 1, k)] = right.value + KELVIN_OFFSET;
+            }
+            if (left.type == BoundaryType::PERIODIC) {
+                u_[idx(n - 1, k)] = u_[idx(0, k)];
+            }
+        }
+    }
+
+    bool HeatEquationSolver2D::has_default_boundaries() const {
+        auto at_u0 = [&](const BoundaryCondition& bc) {
+            return bc.type == BoundaryType::DIRICHLET && bc.value + KELVIN_OFFSET == u0_kelvin_;
+        };
+
+        return side(Side::LEFT).type == BoundaryType::NEUMANN
+            && side(Side::BOTTOM).type == BoundaryType::NEUMANN
+            && at_u0(side(Side::RIGHT))
+            && at_u0(side(Side::TOP));
+    }
+
+    void HeatEquationSolver2D::require_default_boundaries(const char* what) const {
+        if (!has_default_boundaries()) {
+            throw std::logic_error(std::string(what) + " only supports the default boundary conditions");
+        }
+    }
+
+    void HeatEquationSolver2D::set_boundaries(
+        const BoundaryCondition& left
+        , const BoundaryCondition& right
+        , const BoundaryCondition& bottom
+        , const BoundaryCondition& top
+    )
+    {
+        if ((left.type == BoundaryType::PERIODIC) != (right.type == BoundaryType::PERIODIC)
+            || (bottom.type == BoundaryType::PERIODIC) != (top.type == BoundaryType::PERIODIC)) {
+            throw std::invalid_argument("HeatEquationSolver2D: periodic conditions must be set on both sides of an axis");
+        }
+
+        bc_ = {{left, right, bottom, top}};
+        steady_.reset();
+        adi_ready_  = false;
+        spec_valid_ = false;
+        apply_fixed_values();
+        update_stats();
+    }
+
+    void HeatEquationSolver2D::update_stats() {
+        const int n = n_;
+        const StencilKernels& kernels = stencil_kernels();
+        const double inf = std::numeric_limits<double>::infinity();
+        const RowSummary start = {inf, -inf, 0.0, 0.0, 0.0};
+
+        RowSummary total = start;
+        if (n * n < PARALLEL_STATS_POINTS) {
+            kernels.summarize(u_.data(), prev_.data(), 0, n * n, total);
+        } else {
+            // Rows are contiguous, so each worker summarizes its block as one run
+            ThreadPool& workers = pool();
+            for (WorkerSlot& slot : slots_) {
+                slot.summary = start;
+            }
+            workers.parallel_for(0, n, [&](int j0, int j1, int worker) {
+                kernels.summarize(u_.data() + j0 * n, prev_.data() + j0 * n, 0, (j1 - j0) * n, slots_[worker].summary);
+            });
+            for (const WorkerSlot& slot : slots_) {
+                total.min = std::min(total.min, slot.summary.min);
+                total.max = std::max(total.max, slot.summary.max);
+                total.sum += slot.summary.sum;
+                total.sum_sq += slot.summary.sum_sq;
+                total.max_delta = std::max(total.max_delta, slot.summary.max_delta);
+            }
+        }
+
+        const double cell = dx_ * dx_;
+        const double count = static_cast<double>(n) * n;
+        stats_.min = total.min;
+        stats_.max = total.max;
+        stats_.mean = total.sum / count;
+        stats_.l2 = std::sqrt(total.sum_sq * cell);
+        stats_.energy = mat_.rho * mat_.c * (total.sum - count * u0_kelvin_) * cell;
+        stats_.delta = total.max_delta;
+
+        // Flux along each side with the trapezoidal rule, O(n)
+        double flux = 0.0;
+        for (int k = 0; k < n; k++) {
+            double w = (k == 0 || k == n - 1) ? 0.5 : 1.0;
+            flux += w * (outward_flux(side(Side::LEFT),   u_[idx(0, k)],     u_[idx(1, k)],     mat_.lambda, dx_)
+                       + outward_flux(side(Side::RIGHT),  u_[idx(n - 1, k)], u_[idx(n - 2, k)], mat_.lambda, dx_)
+                       + outward_flux(side(Side::BOTTOM), u_[idx(k, 0)],     u_[idx(k, 1)],     mat_.lambda, dx_)
+                       + outward_flux(side(Side::TOP),    u_[idx(k, n - 1)], u_[idx(k, n - 2)], mat_.lambda, dx_));
+        }
+        stats_.boundary_flux = flux * dx_;
+    }
+
     bool HeatEquationSolver2D::step() {
-        if ( t_ >= tmax_) {
+        if (finished()) {
             return false;
         }
+        take_step(tmax_);
+        return true;
+    }
+
+    int HeatEquationSolver2D::advance(int steps, double until) {
+        TraceSpan span("advance", "solver");
+        until = std::min(until, tmax_);
+        int count = 0;
+
+        if (profiling_ || adaptive_ || steady_stop_) {
+            // Each step needs its statistics: timings, error or rate
+            while (count < steps && t_ < until && !finished()) {
+                take_step(until);
+                count++;
+            }
+            span.arg("steps", count);
+            return count;
+        }
+
+        // Same count as calling step(), t_ accumulating the same way
+        double t = t_;
+        while (count < steps && t < until) {
+            t += dt_;
+            count++;
+        }
+
+        // Back to back solves, only the last two steps need statistics,
+        // for the rate and decay of the steady state
+        int k = 0;
+        if (count > 2 && method_ == Method::SPECTRAL) {
+            // The others at once in the eigenbasis
+            skip_spectral(count - 2);
+            for (; k < count - 2; k++) {
+                t_ += dt_;
+            }
+        }
+        for (; k < count; k++) {
+            if (k == count - 2 && k > 0) {
+                std::copy(u_.begin(), u_.end(), prev_.begin());
+            }
+            solve_step();
+            t_ += dt_;
+            if (k >= count - 2) {
+                update_stats();
+                steady_.update(stats_.delta, dt_, t_);
+            }
+        }
+        steps_ += count;
+
+        span.arg("steps", count);
+        span.arg("iterations", last_step_.iterations);
+        return count;
+    }
+
+    int HeatEquationSolver2D::advance_to(double t) {
+        return advance(std::numeric_limits<int>::max(), t);
+    }
+
+    bool HeatEquationSolver2D::finished() const {
+        return t_ >= tmax_ || (steady_stop_ && steady_.get_state().reached);
+    }
+
+    void HeatEquationSolver2D::take_step(double until) {
+        TraceSpan span("step", "solver");
+        span.arg("step", static_cast<double>(steps_));
+
+        StepRecord record;
+        double dt = dt_;
+        {
+            ScopedTimer timer(profiling_ ? &record.at(StepPhase::SOLVE) : nullptr);
+            if (adaptive_) {
+                dt = adaptive_step(until);
+            } else {
+                solve_step();
+            }
+        }
+        span.arg("iterations", last_step_.iterations);
+        span.arg("residual", last_step_.residual);
+        {
+            ScopedTimer timer(profiling_ ? &record.at(StepPhase::STATS) : nullptr);
+            update_stats();
+        }
+
+        if (profiling_) {
+            record.iterations = last_step_.iterations;
+            record.residual = last_step_.residual;
+            record.converged = last_step_.converged;
+            profile_.add(record);
+        }
+
+        t_ += dt;
+        steps_++;
+        steady_.update(stats_.delta, dt, t_);
+    }
+
+    void HeatEquationSolver2D::skip_spectral(int steps) {
+        require_default_boundaries("Spectral");
+
+        Spectral2D& spec = spectral();
+        ThreadPool& workers = pool();
+        const int m = spec.modes();
+        const double r = mat_.alpha() * dt_ / (dx_ * dx_);
+
+        // k steps of c <- g (c + Δt s), g = 1 / (1 + rμ), sum up to
+        // c <- g^k c + Δt s (1 - g^k) / (rμ)
+        if (!spec_valid_) {
+            spec.forward(workers, u_.data(), u0_kelvin_, spec_coef_.data());
+        }
+        for (int k = 0; k < m; k++) {
+            double mu_k = spec.eigenvalue(k);
+            double* c = spec_coef_.data() + k * m;
+            const double* src = spec_src_.data() + k * m;
+            for (int l = 0; l < m; l++) {
+                double rmu = r * (mu_k + spec.eigenvalue(l));
+                double gk = std::pow(1.0 + rmu, -steps);
+                c[l] = gk * c[l] + dt_ * src[l] * (1.0 - gk) / rmu;
+            }
+        }
+        spec.inverse(workers, spec_coef_.data(), u0_kelvin_, u_.data());
+        spec_valid_ = true;
+    }
 
+    void HeatEquationSolver2D::solve_step() {
         double alpha    = mat_.alpha();
         double r        = alpha * dt_ / (dx_ * dx_);
         double src_coef = dt_ / (mat_.rho * mat_.c);
 
-        std::vector<double> u_sol = u_;
+        switch (method_) {
+            case Method::MULTIGRID:
+                solve_multigrid(r, src_coef);
+                break;
+            case Method::RED_BLACK_SOR:
+                solve_red_black_sor(r, src_coef);
+                break;
+            case Method::ADI:
+                solve_adi(r, src_coef);
+                break;
+            case Method::SPECTRAL:
+                solve_spectral(r);
+                break;
+            case Method::CONJUGATE_GRADIENT:
+                solve_conjugate_gradient(r, src_coef);
+                break;
+            case Method::CHOLESKY:
+                solve_cholesky(r, src_coef);
+                break;
+            case Method::GAUSS_SEIDEL:
+            default:
+                solve_gauss_seidel(r, src_coef);
+                break;
+        }
+        spec_valid_ = (method_ == Method::SPECTRAL);
+    }
+
+    double HeatEquationSolver2D::adaptive_step(double until) {
+        // prev_ holds the field at the start of the step until update_stats()
+        const int order = (method_ == Method::ADI) ? 2 : 1;
+        StepInfo total{0, 0.0};
+        auto solve = [&] {
+            solve_step();
+            total.iterations += last_step_.iterations;
+            total.residual = std::max(total.residual, last_step_.residual);
+            total.converged = total.converged && last_step_.converged;
+        };
+        auto restore = [&] {
+            std::copy(prev_.begin(), prev_.end(), u_.begin());
+            spec_valid_ = false;
+        };
 
+        while (true) {
+            double h = std::min(control_.step_size(), until - t_);
+            total = StepInfo{0, 0.0};
+
+            set_dt(h);
+            solve();
+            full_ = u_;
+
+            restore();
+            set_dt(0.5 * h);
+            solve();
+            solve();
+
+            double difference = 0.0;
+            for (int k = 0; k < n_ * n_; k++) {
+                difference = std::max(difference, std::abs(u_[k] - full_[k]));
+            }
+            if (control_.update(difference, order, h)) {
+                last_step_ = total;
+                return h;
+            }
+            restore();
+        }
+    }
+
+    void HeatEquationSolver2D::set_dt(double dt) {
+        if (dt == dt_) {
+            return;
+        }
+        dt_ = dt;
+
+        double r = mat_.alpha() * dt_ / (dx_ * dx_);
+        adi_ready_ = false;
+        cholesky_.reset();
+        if (multigrid_) {
+            multigrid_->set_rate(r);
+        }
+        if (cg_) {
+            cg_->set_rate(r);
+        }
+    }
+
+    void HeatEquationSolver2D::set_adaptive(bool enabled, const AdaptiveOptions& options) {
+        control_.configure(options);
+        adaptive_ = enabled;
+        if (!adaptive_) {
+            set_dt(control_.get_base_dt());
+        }
+    }
+
+    void HeatEquationSolver2D::solve_gauss_seidel(double r, double src_coef) {
         const int max_iter = 100;
         const double tol = 1e-6;
 
+        const int n = n_;
+        double* u = u_.data();
+        const BoundaryCondition& bottom = side(Side::BOTTOM);
+        const BoundaryCondition& top = side(Side::TOP);
+        const double extra_left   = exchange_term(Side::LEFT, r);
+        const double extra_right  = exchange_term(Side::RIGHT, r);
+        const double extra_bottom = exchange_term(Side::BOTTOM, r);
+        const double extra_top    = exchange_term(Side::TOP, r);
+
+        // RHS: u^n + Δt/(ρc)*F, then iterate in place
+        for (int k = 0; k < n * n; k++) {
+            rhs_[k] = u_[k] + src_coef * F_[k];
+        }
+        add_robin_terms(r);
+
+        last_step_ = StepInfo{0, 0.0};
+
+        // Row kernel instantiated for the x=0/x=L policies, rows resolve
+        // their y=0/y=L condition once each
+        auto iterate = [&](auto left, auto right) {
+            using Left  = decltype(left);
+            using Right = decltype(right);
+
+            for (int iter = 0; iter < max_iter; iter++)
+            {
+                double max_diff = 0.0;
+
+                for (int j = 0; j < n; ++j) {
+                    RowStencil s;
+                    if (!row_stencil(j, n, u, r, bottom, top, extra_bottom, extra_top, s)) {
+                        continue;
+                    }
+
+                    double diff = gauss_seidel_row<Left, Right>(
+                        u + j * n, rhs_.data() + j * n, s, n, r, extra_left, extra_right);
+                    max_diff = std::max(max_diff, diff);
+
+                    if (j == 0 && bottom.type == BoundaryType::PERIODIC) {
+                        std::copy(u, u + n, u + (n - 1) * n);
+                    }
+                }
+
+                last_step_ = StepInfo{iter + 1, max_diff};
+
+                if (max_diff < tol) {
+                    break;
+                }
+            }
+        };
+
+        boundary::visit(side(Side::LEFT).type, [&](auto left) {
+            boundary::visit(side(Side::RIGHT).type, [&](auto right) {
+                iterate(left, right);
+            });
+        });
+        last_step_.converged = last_step_.residual < tol;
+    }
+
+    void HeatEquationSolver2D::solve_multigrid(double r, double src_coef) {
+        const int max_cycles = 20;
+        const double tol = 1e-6;
+
+        require_default_boundaries("Multigrid");
+
+        if (!multigrid_) {
+            multigrid_ = std::make_unique<Multigrid2D>(n_, r);
+        }
+
+        // RHS: u^n + Δt/(ρc)*F, previous field is the initial guess
+        for (int k = 0; k < n_ * n_; k++) {
+            rhs_[k] = u_[k] + src_coef * F_[k];
+        }
+
+        int cycles = multigrid_->solve(u_, rhs_, tol, max_cycles);
+        last_step_ = StepInfo{cycles, multigrid_->get_last_residual()};
+        last_step_.converged = last_step_.residual < tol;
+    }
+
+    void HeatEquationSolver2D::solve_conjugate_gradient(double r, double src_coef) {
+        const int max_iter = 1000;
+        const double tol = 1e-9;
+
+        require_default_boundaries("PCG");
+
+        if (!cg_) {
+            cg_ = std::make_unique<ConjugateGradient2D>(n_, r, preconditioner_);
+        }
+        cg_->set_preconditioner(preconditioner_);
+
+        // Solve for u - u0 so that the relative residual is measured
+        // against the heat added, not the ambient temperature: A*1 = 1 on
+        // the unknowns, so RHS is u^n - u0 + Δt/(ρc)*F with zero Dirichlet.
+        // The previous field is the initial guess.
+        for (int k = 0; k < n_ * n_; k++) {
+            u_[k]  -= u0_kelvin_;
+            rhs_[k] = u_[k] + src_coef * F_[k];
+        }
+
+        int iterations = cg_->solve(u_, rhs_, tol, max_iter);
+        last_step_ = StepInfo{iterations, cg_->get_last_residual()};
+        last_step_.converged = last_step_.residual < tol;
+
+        for (int k = 0; k < n_ * n_; k++) {
+            u_[k] += u0_kelvin_;
+        }
+    }
+
+    void HeatEquationSolver2D::solve_cholesky(double r, double src_coef) {
+        const int m = n_ - 1;
+
+        require_default_boundaries("Cholesky");
+
+        if (!cholesky_) {
+            cholesky_ = cached_cholesky(n_, r);
+            chol_rhs_.assign(m * m, 0.0);
+        }
+
+        // W * (u^n - u0 + Δt/(ρc)*F) on the unknowns
+        for (int j = 0; j < m; j++) {
+            double wj = (j == 0) ? 0.5 : 1.0;
+            for (int i = 0; i < m; i++) {
+                double w = wj * ((i == 0) ? 0.5 : 1.0);
+                chol_rhs_[j * m + i] = w * (u_[idx(i, j)] - u0_kelvin_ + src_coef * F_[idx(i, j)]);
+            }
+        }
+
+        cholesky_->solve(chol_rhs_.data());
+
+        for (int j = 0; j < m; j++) {
+            for (int i = 0; i < m; i++) {
+                u_[idx(i, j)] = u0_kelvin_ + chol_rhs_[j * m + i];
+            }
+        }
+        last_step_ = StepInfo{0, 0.0};
+    }
+
+    double HeatEquationSolver2D::optimal_relaxation(double r) const {
+        // Slowest mode of the Neumann/Dirichlet grid is cos(pi/(2(n-1))) per axis
+        const double pi = 3.14159265358979323846;
+        double rho = 4.0 * r * std::cos(pi / (2.0 * (n_ - 1))) / (1.0 + 4.0 * r);
+        return 2.0 / (1.0 + std::sqrt(1.0 - rho * rho));
+    }
+
+    void HeatEquationSolver2D::set_threads(int threads) {
+        threads_ = threads;
+        pool_.reset();
+
+        // Spectral workspaces are per worker of the old pool
+        spectral_.reset();
+        spec_valid_ = false;
+    }
+
+    ThreadPool& HeatEquationSolver2D::pool() {
+        if (!pool_) {
+            pool_ = std::make_unique<ThreadPool>(threads_);
+            slots_.assign(pool_->size(), WorkerSlot{0.0, {}});
+        }
+        return *pool_;
+    }
+
+    void HeatEquationSolver2D::solve_red_black_sor(double r, double src_coef) {
+        const int max_iter = 500;
+        const double tol = 1e-6;
+
+        const BoundaryCondition& left   = side(Side::LEFT);
+        const BoundaryCondition& right  = side(Side::RIGHT);
+        const BoundaryCondition& bottom = side(Side::BOTTOM);
+        const BoundaryCondition& top    = side(Side::TOP);
+
+        // A periodic copy is written by the sweep that updates its source,
+        // while the other color may be reading it
+        if (left.type == BoundaryType::PERIODIC || bottom.type == BoundaryType::PERIODIC) {
+            throw std::logic_error("Red-black SOR does not support periodic boundaries");
+        }
+
+        ThreadPool& workers = pool();
+
+        const int n = n_;
+        const double omega = (omega_ > 0.0) ? omega_ : optimal_relaxation(r);
+        const double extra_left   = exchange_term(Side::LEFT, r);
+        const double extra_right  = exchange_term(Side::RIGHT, r);
+        const double extra_bottom = exchange_term(Side::BOTTOM, r);
+        const double extra_top    = exchange_term(Side::TOP, r);
+        const bool free_left  = (left.type != BoundaryType::DIRICHLET);
+        const bool free_right = (right.type != BoundaryType::DIRICHLET);
+        double* u = u_.data();
+        const double* b = rhs_.data();
+        const StencilKernels& kernels = stencil_kernels();
+
+        // RHS: u^n + Δt/(ρc)*F
+        workers.parallel_for(0, n * n, [&](int k0, int k1, int) {
+            for (int k = k0; k < k1; k++) {
+                rhs_[k] = u_[k] + src_coef * F_[k];
+            }
+        });
+        add_robin_terms(r);
+
+        // Over-relaxed update of a boundary column, its ghost point being
+        // the mirror of the inner neighbour
+        auto relax_edge = [&](double* row, const RowStencil& s, const double* bj
+                              , int i, int inner, double inv_diag) {
+            double gs = (bj[i] + r * (2.0 * row[inner] + s.dn[i] + s.up[i])) * inv_diag;
+            double delta = omega * (gs - row[i]);
+            row[i] += delta;
+            return std::abs(delta);
+        };
+
+        // Rows [j0, j1) of one color, Dirichlet rows/columns are never updated
+        auto sweep = [&](int j0, int j1, int worker, int color) {
+            double max_diff = 0.0;
+
+            for (int j = j0; j < j1; j++) {
+                RowStencil s;
+                row_stencil(j, n, u, r, bottom, top, extra_bottom, extra_top, s);
+                double* row      = u + j * n;
+                const double* bj = b + j * n;
+                double inv_diag  = 1.0 / s.diag;
+
+                int parity = (color + j) & 1;
+                if (parity == 0 && free_left) {
+                    max_diff = std::max(max_diff
+                                        , relax_edge(row, s, bj, 0, 1, 1.0 / (s.diag + extra_left)));
+                }
+                max_diff = std::max(max_diff
+                                    , kernels.relax(s.dn, row, s.up, bj, 1, n - 1, parity, r, inv_diag, omega));
+                if (((n - 1) & 1) == parity && free_right) {
+                    max_diff = std::max(max_diff
+                                        , relax_edge(row, s, bj, n - 1, n - 2, 1.0 / (s.diag + extra_right)));
+                }
+            }
+
+            slots_[worker].max_diff = std::max(slots_[worker].max_diff, max_diff);
+        };
+
+        const int j_begin = (bottom.type == BoundaryType::DIRICHLET) ? 1 : 0;
+        const int j_end   = (top.type == BoundaryType::DIRICHLET) ? n - 1 : n;
+
         for (int iter = 0; iter < max_iter; iter++)
         {
+            for (WorkerSlot& slot : slots_) {
+                slot.max_diff = 0.0;
+            }
+
+            for (int color = 0; color < 2; color++) {
+                workers.parallel_for(j_begin, j_end, [&](int j0, int j1, int worker) {
+                    sweep(j0, j1, worker, color);
+                });
+            }
+
             double max_diff = 0.0;
+            for (const WorkerSlot& slot : slots_) {
+                max_diff = std::max(max_diff, slot.max_diff);
+            }
+            last_step_ = StepInfo{iter + 1, max_diff};
+
+            if (max_diff < tol) {
+                break;
+            }
+        }
+        last_step_.converged = last_step_.residual < tol;
+    }
+
+    void HeatEquationSolver2D::transpose(const std::vector<double>& src, std::vector<double>& dst) {
+        const int n = n_;
+        const int block = 32;
+        const int n_blocks = (n + block - 1) / block;
+
+        pool().parallel_for(0, n_blocks, [&](int b0, int b1, int) {
+            for (int jb = b0 * block; jb < std::min(n, b1 * block); jb += block) {
+                int j_end = std::min(n, jb + block);
+                for (int ib = 0; ib < n; ib += block) {
+                    int i_end = std::min(n, ib + block);
+                    for (int j = jb; j < j_end; j++) {
+                        for (int i = ib; i < i_end; i++) {
+                            dst[i * n + j] = src[j * n + i];
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    void HeatEquationSolver2D::build_adi_line(AdiLine& line, Side lo, Side hi, double half_r) {
+        const int n = n_;
+        std::vector<double> a(n, -half_r);
+        std::vector<double> b(n, 1.0 + 2.0 * half_r);
+        std::vector<double> c(n, -half_r);
 
-            for (int j = 0; j < n_; ++j) {
-                for (int i = 0; i < n_; ++i) {
-                    // Dirichlet BC at x=L or y=L
-                    if (i == n_ - 1 || j == n_ - 1) {
-                        u_sol[idx(i, j)] = u0_kelvin_;
+        line.rhs_lo = 0.0;
+        line.rhs_hi = 0.0;
+
+        if (side(lo).type == BoundaryType::PERIODIC) {
+            // Last point is the first one: n-1 unknowns, coupled through the corners
+            a.resize(n - 1);
+            b.resize(n - 1);
+            c.resize(n - 1);
+            line.solver.factorize_cyclic(a, b, c);
+            return;
+        }
+
+        boundary::visit(side(lo).type, [&](auto policy) {
+            line_boundary<decltype(policy)>(side(lo), dx_, half_r, b[0], c[0], line.rhs_lo);
+        });
+        boundary::visit(side(hi).type, [&](auto policy) {
+            line_boundary<decltype(policy)>(side(hi), dx_, half_r, b[n - 1], a[n - 1], line.rhs_hi);
+        });
+        c[n - 1] = 0.0;
+
+        line.solver.factorize(a, b, c);
+    }
+
+    void HeatEquationSolver2D::solve_adi(double r, double src_coef) {
+        const int n = n_;
+        const double half_r = 0.5 * r;
+        const double half_src = 0.5 * src_coef;
+
+        if (!adi_ready_) {
+            // Line operators I - (r/2)δ², by default the Neumann mirror at 0
+            // and Dirichlet at n-1, identical for x and y lines
+            build_adi_line(adi_x_, Side::LEFT, Side::RIGHT, half_r);
+            build_adi_line(adi_y_, Side::BOTTOM, Side::TOP, half_r);
+
+            adi_row_.assign(n * n, u0_kelvin_);
+            adi_col_.assign(n * n, u0_kelvin_);
+            F_col_.assign(n * n, 0.0);
+            transpose(F_, F_col_);
+            adi_ready_ = true;
+        }
+
+        ThreadPool& workers = pool();
+
+        // Line k of dst = (I + (r/2)δ²) along the slow index of src, plus
+        // half the source, then solved with (I - (r/2)δ²) along the line.
+        // lo/hi are the sides at the ends of the lines, slow_lo/slow_hi
+        // the ones at the first and last line.
+        auto half_step = [&](const std::vector<double>& src, const std::vector<double>& F
+                             , std::vector<double>& dst, const AdiLine& line
+                             , Side lo, Side hi, Side slow_lo, Side slow_hi) {
+            const BoundaryCondition& first = side(slow_lo);
+            const BoundaryCondition& last  = side(slow_hi);
+            const BoundaryType lo_type = side(lo).type;
+            const BoundaryType hi_type = side(hi).type;
+            const bool wrap = (first.type == BoundaryType::PERIODIC);
+
+            // Explicit Robin term -(r/2) 2Δx h/λ (u - u_ext) on a first or last line
+            auto add_exchange = [&](double* d, const double* mid, const BoundaryCondition& bc) {
+                double e = half_r * 2.0 * bc.coefficient * dx_;
+                double u_ext = bc.value + KELVIN_OFFSET;
+                for (int i = 0; i < n; i++) {
+                    d[i] -= e * (mid[i] - u_ext);
+                }
+            };
+
+            // The last line of a periodic direction is copied from the first one
+            workers.parallel_for(0, wrap ? n - 1 : n, [&](int k0, int k1, int) {
+                for (int k = k0; k < k1; k++) {
+                    double* d = dst.data() + k * n;
+
+                    if (k == 0 && first.type == BoundaryType::DIRICHLET) {
+                        std::fill(d, d + n, first.value + KELVIN_OFFSET);
+                        continue;
+                    }
+                    if (k == n - 1 && last.type == BoundaryType::DIRICHLET) {
+                        std::fill(d, d + n, last.value + KELVIN_OFFSET);
                         continue;
                     }
 
-                    double old_val = u_sol[idx(i, j)];
+                    // Ghost line at k=0 is the mirror of line 1, or wraps to n-2
+                    int k_lo = (k > 0) ? k - 1 : (wrap ? n - 2 : 1);
+                    int k_hi = (k < n - 1) ? k + 1 : n - 2;
+                    const double* lo_line = src.data() + k_lo * n;
+                    const double* mid     = src.data() + k * n;
+                    const double* hi_line = src.data() + k_hi * n;
+                    const double* f       = F.data() + k * n;
 
-                    // Neighbors with Neumann BC at i=0, j=0
-                    double u_left  = (i > 0) ? u_sol[idx(i - 1, j)] : u_sol[idx(1, j)];
-                    double u_right = u_sol[idx(i + 1, j)];
-                    double u_down  = (j > 0) ? u_sol[idx(i, j - 1)] : u_sol[idx(i, 1)];
-                    double u_up    = u_sol[idx(i, j + 1)];
+                    for (int i = 0; i < n; i++) {
+                        d[i] = mid[i] + half_r * (lo_line[i] - 2.0 * mid[i] + hi_line[i]) + half_src * f[i];
+                    }
+                    if (k == 0 && first.type == BoundaryType::ROBIN) {
+                        add_exchange(d, mid, first);
+                    }
+                    if (k == n - 1 && last.type == BoundaryType::ROBIN) {
+                        add_exchange(d, mid, last);
+                    }
 
-                    double rhs     = u_[idx(i, j)] + src_coef * F_[idx(i, j)];
-                    u_sol[idx(i, j)] = (rhs + r * (u_left + u_right + u_down + u_up)) 
-                                       / (1.0 + 4.0 * r);
+                    // Boundary rows of the line system
+                    if (lo_type == BoundaryType::DIRICHLET) {
+                        d[0] = line.rhs_lo;
+                    } else if (lo_type == BoundaryType::ROBIN) {
+                        d[0] += line.rhs_lo;
+                    }
+                    if (hi_type == BoundaryType::DIRICHLET) {
+                        d[n - 1] = line.rhs_hi;
+                    } else if (hi_type == BoundaryType::ROBIN) {
+                        d[n - 1] += line.rhs_hi;
+                    }
 
-                    max_diff = std::max(max_diff, std::abs(u_sol[idx(i, j)] - old_val));
+                    line.solver.solve(d);
+                    if (lo_type == BoundaryType::PERIODIC) {
+                        d[n - 1] = d[0];
+                    }
                 }
+            });
+
+            if (wrap) {
+                std::copy(dst.begin(), dst.begin() + n, dst.begin() + (n - 1) * n);
             }
+        };
 
-            if (max_diff < tol) {
-                break;
+        last_step_ = StepInfo{0, 0.0};
+
+        // x-implicit: lines are rows, explicit part along y
+        half_step(u_, F_, adi_row_, adi_x_, Side::LEFT, Side::RIGHT, Side::BOTTOM, Side::TOP);
+
+        // y-implicit: lines are columns of u*, explicit part along x
+        transpose(adi_row_, adi_col_);
+        half_step(adi_col_, F_col_, adi_row_, adi_y_, Side::BOTTOM, Side::TOP, Side::LEFT, Side::RIGHT);
+        transpose(adi_row_, u_);
+    }
+
+    Spectral2D& HeatEquationSolver2D::spectral() {
+        if (!spectral_) {
+            ThreadPool& workers = pool();
+            int m = n_ - 1;
+
+            spectral_ = std::make_unique<Spectral2D>(n_, workers.size());
+            spec_coef_.assign(m * m, 0.0);
+            spec_src_.assign(m * m, 0.0);
+
+            // Source rate F/(ρc), zero on the Dirichlet points
+            double rate = 1.0 / (mat_.rho * mat_.c);
+            for (int k = 0; k < n_ * n_; k++) {
+                rhs_[k] = rate * F_[k];
             }
+            spectral_->forward(workers, rhs_.data(), 0.0, spec_src_.data());
         }
+        return *spectral_;
+    }
 
-        u_ = u_sol;
-        t_ += dt_;
+    void HeatEquationSolver2D::solve_spectral(double r) {
+        require_default_boundaries("Spectral");
 
-        return true;
+        Spectral2D& spec = spectral();
+        ThreadPool& workers = pool();
+        const int m = spec.modes();
+
+        // (1 + r(μk + μl)) c^{n+1} = c^n + Δt * s
+        if (!spec_valid_) {
+            spec.forward(workers, u_.data(), u0_kelvin_, spec_coef_.data());
+        }
+        for (int k = 0; k < m; k++) {
+            double mu_k = spec.eigenvalue(k);
+            double* c = spec_coef_.data() + k * m;
+            const double* src = spec_src_.data() + k * m;
+            for (int l = 0; l < m; l++) {
+                c[l] = (c[l] + dt_ * src[l]) / (1.0 + r * (mu_k + spec.eigenvalue(l)));
+            }
+        }
+        spec.inverse(workers, spec_coef_.data(), u0_kelvin_, u_.data());
+        last_step_ = StepInfo{0, 0.0};
+    }
+
+    void HeatEquationSolver2D::jump_to(double t) {
+        t = std::min(t, tmax_);
+        if (t <= t_) {
+            return;
+        }
+        require_default_boundaries("jump_to");
+
+        Spectral2D& spec = spectral();
+        ThreadPool& workers = pool();
+        const int m = spec.modes();
+        const double tau = t - t_;
+        const double rate = mat_.alpha() / (dx_ * dx_);
+
+        if (!spec_valid_) {
+            spec.forward(workers, u_.data(), u0_kelvin_, spec_coef_.data());
+        }
+        for (int k = 0; k < m; k++) {
+            double mu_k = spec.eigenvalue(k);
+            double* c = spec_coef_.data() + k * m;
+            const double* src = spec_src_.data() + k * m;
+            for (int l = 0; l < m; l++) {
+                double kappa = rate * (mu_k + spec.eigenvalue(l));
+                double decay = std::exp(-kappa * tau);
+                c[l] = decay * c[l] + (1.0 - decay) * src[l] / kappa;
+            }
+        }
+        spec.inverse(workers, spec_coef_.data(), u0_kelvin_, u_.data());
+        spec_valid_ = true;
+        update_stats();
+
+        t_ = t;
+    }
+
+    void HeatEquationSolver2D::solve_steady() {
+        require_default_boundaries("solve_steady");
+
+        Spectral2D& spec = spectral();
+        ThreadPool& workers = pool();
+        const int m = spec.modes();
+        const double rate = mat_.alpha() / (dx_ * dx_);
+
+        // κ c = s for every mode, the limit of jump_to()
+        for (int k = 0; k < m; k++) {
+            double mu_k = spec.eigenvalue(k);
+            double* c = spec_coef_.data() + k * m;
+            const double* src = spec_src_.data() + k * m;
+            for (int l = 0; l < m; l++) {
+                c[l] = src[l] / (rate * (mu_k + spec.eigenvalue(l)));
+            }
+        }
+        spec.inverse(workers, spec_coef_.data(), u0_kelvin_, u_.data());
+        spec_valid_ = true;
+        last_step_ = StepInfo{0, 0.0};
+        update_stats();
+
+        // μ_0 is the smallest eigenvalue, prev_ held the replaced field
+        steady_.solved(stats_.delta, 2.0 * rate * spec.eigenvalue(0), t_);
+    }
+
+    void HeatEquationSolver2D::set_steady_stop(bool enabled, double tolerance) {
+        steady_.set_tolerance(tolerance);
+        steady_stop_ = enabled;
     }
 
     std::vector<std::vector<double>> HeatEquationSolver2D::get_temperature_2d() const {
@@ -138,6 +1194,36 @@ namespace ensiie {
     void HeatEquationSolver2D::reset()
     {
         t_ = 0.0;
+        steps_ = 0;
+        control_.reset();
+        steady_.reset();
+        set_dt(control_.get_base_dt());
+        spec_valid_ = false;
+        last_step_ = StepInfo{0, 0.0};
+        profile_ = StepProfile{};
         std::fill(u_.begin(), u_.end(), u0_kelvin_);
+        apply_fixed_values();
+        prev_ = u_;
+        update_stats();
+    }
+
+    void HeatEquationSolver2D::set_profiling(bool enabled)
+    {
+        profiling_ = enabled;
+        profile_ = StepProfile{};
+    }
+
+    const char* to_string(HeatEquationSolver2D::Method method)
+    {
+        switch (method) {
+            case HeatEquationSolver2D::Method::GAUSS_SEIDEL: return "Gauss-Seidel";
+            case HeatEquationSolver2D::Method::MULTIGRID:    return "Multigrid";
+            case HeatEquationSolver2D::Method::RED_BLACK_SOR: return "Red-black SOR";
+            case HeatEquationSolver2D::Method::ADI:          return "ADI";
+            case HeatEquationSolver2D::Method::SPECTRAL:     return "Spectral";
+            case HeatEquationSolver2D::Method::CONJUGATE_GRADIENT: return "PCG";
+            case HeatEquationSolver2D::Method::CHOLESKY:     return "Cholesky";
+        }
+        return "Unknown";
     }
 }
\ No newline at end of file
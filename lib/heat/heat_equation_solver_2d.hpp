@@ -1,7 +1,24 @@
 #ifndef HEAT_EQUATION_SOLVER_2D_HPP
 #define HEAT_EQUATION_SOLVER_2D_HPP
 
+#include "banded_cholesky.hpp"
+#include "boundary_conditions.hpp"
+#include "conjugate_gradient_2d.hpp"
+#include "field_stats.hpp"
+#include "field_view.hpp"
 #include "material.hpp"
+#include "multigrid_2d.hpp"
+#include "spectral_2d.hpp"
+#include "steady_state.hpp"
+#include "step_control.hpp"
+#include "stencil_kernels.hpp"
+#include "step_profile.hpp"
+#include "thread_pool.hpp"
+#include "tridiagonal_solver.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <vector>
 
 namespace ensiie {
@@ -9,25 +26,114 @@ namespace ensiie {
      * @class HeatEquationSolver2D
      * @brief Solves 2D heat equation with implicit finite differences
      * 
-     * Boundary conditions:
+     * Boundary conditions, by default:
      * - Neumann at x=0, y=0
      * - Dirichlet at x=L, y=L
+     *
+     * Gauss-Seidel, red-black SOR and ADI accept any condition per side
+     * with set_boundaries(), the other methods rely on the default ones.
      */
 
     class HeatEquationSolver2D {
+        public:
+            /**
+             * @brief Linear solver used for the implicit system of each step
+             */
+            enum class Method {
+                GAUSS_SEIDEL,   ///< Lexicographic Gauss-Seidel iteration
+                MULTIGRID,      ///< Geometric multigrid V-cycles
+                RED_BLACK_SOR,  ///< Multithreaded red-black SOR iteration
+                ADI,            ///< Peaceman-Rachford alternating direction implicit
+                SPECTRAL,       ///< Direct solve in the cosine eigenbasis
+                CONJUGATE_GRADIENT, ///< Matrix-free preconditioned conjugate gradient
+                CHOLESKY        ///< Direct solve with a cached banded Cholesky factor
+            };
+
+            /**
+             * @brief Convergence report of the last step
+             */
+            struct StepInfo {
+                int iterations;     ///< Sweeps, V-cycles or CG iterations, 0 for direct methods
+                double residual;    ///< Final value of the method's stopping criterion
+                bool converged = true; ///< false if the iteration cap stopped the step
+            };
+
+            /**
+             * @brief Sides of the plate
+             */
+            enum class Side {
+                LEFT,       ///< x = 0
+                RIGHT,      ///< x = L
+                BOTTOM,     ///< y = 0
+                TOP         ///< y = L
+            };
+
         private:
+            /// Per-thread reduction slot, padded to its own cache line
+            struct alignas(64) WorkerSlot {
+                double max_diff;
+                RowSummary summary;     ///< Statistics of the worker's rows
+            };
+
+            /// ADI line operator of one direction with its boundary rows
+            struct AdiLine {
+                TridiagonalSolver solver;   ///< Prefactored I - (r/2)δ² of one line
+                double rhs_lo;              ///< Dirichlet value or Robin term of the first point
+                double rhs_hi;              ///< Dirichlet value or Robin term of the last point
+            };
+
             Material mat_;              ///< Material properties
             double L_;                  ///< Plate side length
             double tmax_;               ///< Max simulation time
             double dx_;                 ///< Spatial step
-            double dt_;                 ///< Time step
+            double dt_;                 ///< Time step of the current operators
             double u0_kelvin_;          ///< Initial temp in Kelvin
             double t_;                  ///< Current time
+            std::uint64_t steps_;       ///< Steps since the start
 
             int n_;                     ///< Number of points per dimension
 
             std::vector<double> u_;     ///< Temperature field (row-major)
             std::vector<double> F_;     ///< Heat source term
+            std::vector<double> rhs_;   ///< Right hand side of the implicit system
+            StepInfo last_step_;        ///< Convergence of the last step
+            std::vector<double> prev_;  ///< Field before the last step, for FieldStats::delta
+            FieldStats stats_;          ///< Statistics of the current field
+            bool profiling_;            ///< Time the steps into profile_
+            StepProfile profile_;       ///< Timings and convergence of the profiled steps
+            bool adaptive_;             ///< Step size chosen by control_
+            StepControl control_;       ///< Step doubling controller
+            std::vector<double> full_;  ///< Field after the full step of an attempt
+            SteadyStateMonitor steady_; ///< Rate of change and equilibrium estimate
+            bool steady_stop_;          ///< step() stops once steady_ is reached
+
+            std::array<BoundaryCondition, 4> bc_;   ///< Conditions indexed by Side
+
+            Method method_;                         ///< Selected linear solver
+            std::unique_ptr<Multigrid2D> multigrid_; ///< Grid hierarchy, built on first use
+
+            double omega_;                          ///< SOR relaxation factor, 0 for optimal
+            int threads_;                           ///< SOR threads, 0 for hardware concurrency
+            std::unique_ptr<ThreadPool> pool_;      ///< SOR workers, built on first use
+            std::vector<WorkerSlot> slots_;         ///< Per-thread max update of a sweep
+
+            AdiLine adi_x_;                         ///< Operator of the x lines (rows)
+            AdiLine adi_y_;                         ///< Operator of the y lines (columns)
+            bool adi_ready_;                        ///< Line operators match r and the boundaries
+            std::vector<double> adi_row_;           ///< ADI half step field, row-major
+            std::vector<double> adi_col_;           ///< ADI half step field, column-major
+            std::vector<double> F_col_;             ///< Heat source, column-major
+
+            std::unique_ptr<Spectral2D> spectral_;  ///< Eigenbasis transforms, built on first use
+            std::vector<double> spec_coef_;         ///< Field coefficients in the eigenbasis
+            std::vector<double> spec_src_;          ///< Coefficients of F/(ρc)
+            bool spec_valid_;                       ///< spec_coef_ matches u_, no forward transform needed
+
+            ConjugateGradient2D::Preconditioner preconditioner_; ///< CG preconditioner
+            std::unique_ptr<ConjugateGradient2D> cg_;            ///< CG work vectors, built on first use
+
+            std::shared_ptr<const BandedCholesky> cholesky_;    ///< Shared factor of the symmetrized system
+            std::vector<double> chol_rhs_;                      ///< Unknowns in factor order
 
             /**
              * @brief Convert 2D index to 1D
@@ -50,6 +156,181 @@ namespace ensiie {
              */
             void init_source(double f);
 
+            /**
+             * @brief Get the condition of one side
+             */
+            const BoundaryCondition& side(Side s) const { return bc_[static_cast<int>(s)]; }
+
+            /**
+             * @brief Diagonal term 2r Δx h/λ of the ghost point elimination on a side
+             * @return 0 unless the side is Robin
+             */
+            double exchange_term(Side s, double r) const;
+
+            /**
+             * @brief Add the Robin terms 2r Δx h/λ u_ext to rhs_ on the boundary points
+             */
+            void add_robin_terms(double r);
+
+            /**
+             * @brief Set Dirichlet points to their value, and the periodic copies
+             *
+             * At a corner the x side wins.
+             */
+            void apply_fixed_values();
+
+            /**
+             * @brief Compute stats_ in one parallel SIMD pass over u_ and prev_
+             *
+             * Sets prev_ to u_ for the next step on the way.
+             */
+            void update_stats();
+
+            /**
+             * @brief Set the step size, updating the rate of the cached operators
+             *
+             * Multigrid and CG keep their grids, ADI lines and the Cholesky
+             * factor are looked up again on their next use.
+             */
+            void set_dt(double dt);
+
+            /**
+             * @brief Advance u_ by one step of dt_ with the selected method, without statistics
+             */
+            void solve_step();
+
+            /**
+             * @brief Advance u_ by one controlled step, from prev_
+             *
+             * Step doubling as in the 1D solver; last_step_ sums the
+             * iterations of the three solves of the accepted attempt.
+             * @param until The step ends at this time at the latest
+             * @return Size of the step taken
+             */
+            double adaptive_step(double until);
+
+            /**
+             * @brief Check for tmax, or the steady state when it stops the run
+             */
+            bool finished() const;
+
+            /**
+             * @brief One step with its statistics, profile and steady state update
+             * @param until Time an adaptive step must not pass
+             */
+            void take_step(double until);
+
+            /**
+             * @brief Take several spectral steps at once, without statistics
+             *
+             * Each mode of an implicit step is multiplied by g = 1/(1 + rμ),
+             * so the steps amount to one geometric sum per mode and a single
+             * inverse transform.
+             */
+            void skip_spectral(int steps);
+
+            /**
+             * @brief Throw unless the boundaries are the default ones
+             * @param what Name of the caller for the message
+             * @throws std::logic_error
+             */
+            void require_default_boundaries(const char* what) const;
+
+            /**
+             * @brief Factorize the line operator of one ADI direction
+             * @param line Operator to build
+             * @param lo Condition at the start of the lines
+             * @param hi Condition at the end of the lines
+             * @param half_r Half rate r/2
+             */
+            void build_adi_line(AdiLine& line, Side lo, Side hi, double half_r);
+
+            /**
+             * @brief Solve the implicit system with Gauss-Seidel
+             * @param r Rate α*Δt/Δx²
+             * @param src_coef Source coefficient Δt/(ρc)
+             */
+            void solve_gauss_seidel(double r, double src_coef);
+
+            /**
+             * @brief Solve the implicit system with multigrid V-cycles
+             * @param r Rate α*Δt/Δx²
+             * @param src_coef Source coefficient Δt/(ρc)
+             */
+            void solve_multigrid(double r, double src_coef);
+
+            /**
+             * @brief Solve the implicit system with preconditioned conjugate gradient
+             *
+             * Warm started from the previous field.
+             * @param r Rate α*Δt/Δx²
+             * @param src_coef Source coefficient Δt/(ρc)
+             */
+            void solve_conjugate_gradient(double r, double src_coef);
+
+            /**
+             * @brief Solve the implicit system with the banded Cholesky factor
+             *
+             * The factor is looked up in a process-wide cache keyed by (n, r),
+             * so it is computed once for all solvers and runs sharing a grid
+             * and a rate, and survives reset().
+             * @param r Rate α*Δt/Δx²
+             * @param src_coef Source coefficient Δt/(ρc)
+             */
+            void solve_cholesky(double r, double src_coef);
+
+            /**
+             * @brief Solve the implicit system with red-black SOR
+             *
+             * Points of one color only depend on points of the other color,
+             * so each color sweep is split by row blocks over the thread pool.
+             * @param r Rate α*Δt/Δx²
+             * @param src_coef Source coefficient Δt/(ρc)
+             */
+            void solve_red_black_sor(double r, double src_coef);
+
+            /**
+             * @brief Advance one step with Peaceman-Rachford ADI
+             *
+             * Implicit in x then in y over two half steps, each one being a
+             * set of independent tridiagonal systems solved in parallel.
+             * The y half step works on the transposed field so that every
+             * line is contiguous. Second order in time, no iteration.
+             * @param r Rate α*Δt/Δx²
+             * @param src_coef Source coefficient Δt/(ρc)
+             */
+            void solve_adi(double r, double src_coef);
+
+            /**
+             * @brief Solve the implicit system exactly in the cosine eigenbasis
+             *
+             * Every mode is decoupled, so a backward Euler step is one
+             * division per coefficient between two fast transforms.
+             * @param r Rate α*Δt/Δx²
+             */
+            void solve_spectral(double r);
+
+            /**
+             * @brief Get the eigenbasis transforms, built on first use
+             */
+            Spectral2D& spectral();
+
+            /**
+             * @brief Cache-blocked n x n transpose, run over the thread pool
+             */
+            void transpose(const std::vector<double>& src, std::vector<double>& dst);
+
+            /**
+             * @brief Get the worker pool, built on first use
+             */
+            ThreadPool& pool();
+
+            /**
+             * @brief Optimal SOR factor 2/(1+sqrt(1-ρ²)) from the Jacobi spectral radius ρ
+             * @param r Rate α*Δt/Δx²
+             */
+            double optimal_relaxation(double r) const;
+
         public:
             /**
              * @brief Constructor
@@ -59,6 +340,7 @@ namespace ensiie {
              * @param u0 Initial temperature (Celsius)
              * @param f Heat source amplitude (Celsius)
              * @param n Number of points per dimension
+             * @param method Linear solver for the implicit system
              */
             HeatEquationSolver2D(
                 const Material& mat
@@ -67,6 +349,7 @@ namespace ensiie {
                 , double u0
                 , double f
                 , int n
+                , Method method = Method::GAUSS_SEIDEL
             );
 
             /**
@@ -75,6 +358,43 @@ namespace ensiie {
              */
             bool step();
 
+            /**
+             * @brief Take up to steps time steps in one call
+             *
+             * Gives the field of as many step() calls. With fixed steps and
+             * neither profiling nor the steady stop, the solves run back to
+             * back and the statistics and steady state are only updated by
+             * the last two. The spectral method takes the others at once in
+             * the eigenbasis: three inverse transforms whatever the number
+             * of steps, the time blocking of an exact per-mode update.
+             * @param steps Steps at most
+             * @param until Steps are taken while the time is below, at most tmax
+             * @return Steps taken, fewer than steps once the run is finished or until is reached
+             */
+            int advance(int steps, double until = std::numeric_limits<double>::infinity());
+
+            /**
+             * @brief Take steps until the time reaches t, as advance()
+             *
+             * Fixed steps end on the first multiple of dt at or past t,
+             * adaptive ones are shortened to end on t. Unlike jump_to(),
+             * the field is the one of the time steps.
+             * @param t Target time, clamped to tmax
+             * @return Steps taken
+             */
+            int advance_to(double t);
+
+            /**
+             * @brief Jump directly to time t
+             *
+             * Uses the closed form evolution of each eigenmode,
+             * c(t) = e^{-κΔt} c + (1 - e^{-κΔt}) s/κ, which is exact in time
+             * for the space-discretized problem, whatever the method.
+             * @param t Target time, clamped to tmax
+             * @throws std::logic_error if the boundaries are not the default ones
+             */
+            void jump_to(double t);
+
             /**
              * @brief Get temperature at grid point
              * @param i X index
@@ -83,12 +403,111 @@ namespace ensiie {
              */
             double get_temperature(int i, int j) const { return u_[idx(i, j)]; }
 
+            /**
+             * @brief Get a view of the temperature field, without copy
+             * @return Row-major view, (i, j) in Kelvin, valid until the solver is destroyed
+             */
+            FieldView get_field() const { return FieldView(u_, n_, n_); }
+
             /**
              * @brief Get temperature field as 2D vector
              * @return 2D temperature array [row][col] in Kelvin
+             *
+             * Allocates one vector per row, get_field() reads in place.
              */
             std::vector<std::vector<double>> get_temperature_2d() const;
 
+            /**
+             * @brief Get the statistics of the current field
+             *
+             * Updated by every step, so reading them costs nothing.
+             */
+            const FieldStats& get_stats() const { return stats_; }
+
+            /**
+             * @brief Time the phases of every step, off by default
+             *
+             * Disabled, a step costs one branch per phase more. Enabling
+             * clears the profile.
+             */
+            void set_profiling(bool enabled);
+
+            /**
+             * @brief Check whether steps are profiled
+             */
+            bool is_profiling() const { return profiling_; }
+
+            /**
+             * @brief Get the timings and convergence of the profiled steps
+             *
+             * Totals since profiling was enabled or the last reset(), and
+             * the last step, whose iterations tell whether it stopped at
+             * the cap of its method without converging.
+             */
+            const StepProfile& get_profile() const { return profile_; }
+
+            /**
+             * @brief Stop the run once the field is steady, off by default
+             *
+             * The rate max |Δu|/Δt of every step is followed either way, for
+             * get_steady_state(). Enabled, step() returns false once it falls
+             * below the tolerance.
+             * @param tolerance Rate of a steady field, in K/s
+             * @throws std::invalid_argument unless tolerance > 0
+             */
+            void set_steady_stop(bool enabled, double tolerance = DEFAULT_STEADY_TOLERANCE);
+
+            /**
+             * @brief Check whether the field has reached its equilibrium
+             */
+            bool is_steady() const { return steady_.get_state().reached; }
+
+            /**
+             * @brief Get the last rate of change and the time-to-equilibrium estimate
+             */
+            const SteadyState& get_steady_state() const { return steady_.get_state(); }
+
+            /**
+             * @brief Replace the field with the equilibrium, in one direct solve
+             *
+             * The stationary problem is diagonal in the cosine eigenbasis,
+             * each mode being s/κ: the fastest solve available, whatever
+             * the method. The time is left unchanged; the estimate of
+             * get_steady_state() is when the replaced field would have
+             * got there, decaying at the slowest mode.
+             * @throws std::logic_error if the boundaries are not the default ones
+             */
+            void solve_steady();
+
+            /**
+             * @brief Choose the step size by step doubling, off by default
+             *
+             * Off, every step is tmax/1000. On, steps are tmax/1000 times a
+             * power of two, chosen from the difference between a step and
+             * two half steps: backward Euler is first order and ADI second
+             * order. Each step costs three solves; the rates come back
+             * from one step to the next, so factorizations are mostly
+             * reused, but a Cholesky factor is built per new size.
+             * Restarts the controller.
+             * @throws std::invalid_argument on invalid options
+             */
+            void set_adaptive(bool enabled, const AdaptiveOptions& options = AdaptiveOptions());
+
+            /**
+             * @brief Check whether the step size is adaptive
+             */
+            bool is_adaptive() const { return adaptive_; }
+
+            /**
+             * @brief Get the size of the next step
+             */
+            double get_dt() const { return adaptive_ ? control_.step_size() : dt_; }
+
+            /**
+             * @brief Get the accepted and rejected steps of the adaptive run
+             */
+            const StepControl& get_step_control() const { return control_; }
+
             /**
              * @brief Get current simulation time
              * @return Time in seconds
@@ -106,11 +525,92 @@ namespace ensiie {
              */
             int get_n() const { return n_; }
 
+            /**
+             * @brief Select the linear solver used by step()
+             */
+            void set_method(Method method) { method_ = method; }
+
+            /**
+             * @brief Get the linear solver used by step()
+             */
+            Method get_method() const { return method_; }
+
+            /**
+             * @brief Set the SOR relaxation factor
+             * @param omega Factor in (0, 2), or 0 to use the optimal one
+             */
+            void set_relaxation(double omega) { omega_ = omega; }
+
+            /**
+             * @brief Get the SOR relaxation factor (0 means optimal)
+             */
+            double get_relaxation() const { return omega_; }
+
+            /**
+             * @brief Select the conjugate gradient preconditioner
+             */
+            void set_preconditioner(ConjugateGradient2D::Preconditioner preconditioner) { preconditioner_ = preconditioner; }
+
+            /**
+             * @brief Get the conjugate gradient preconditioner
+             */
+            ConjugateGradient2D::Preconditioner get_preconditioner() const { return preconditioner_; }
+
+            /**
+             * @brief Set the conditions of the four sides
+             *
+             * Defaults are Neumann at x=0 and y=0 and Dirichlet at u0 at
+             * x=L and y=L. A periodic axis has its last line equal to the
+             * first one. Only Gauss-Seidel, ADI and, without periodic
+             * sides, red-black SOR support other conditions, the other
+             * methods, jump_to() and solve_steady() throw std::logic_error.
+             * @throws std::invalid_argument if only one side of an axis is periodic
+             */
+            void set_boundaries(
+                const BoundaryCondition& left
+                , const BoundaryCondition& right
+                , const BoundaryCondition& bottom
+                , const BoundaryCondition& top
+            );
+
+            /**
+             * @brief Get the condition of one side
+             */
+            const BoundaryCondition& get_boundary(Side s) const { return side(s); }
+
+            /**
+             * @brief Check for the default Neumann/Dirichlet conditions
+             */
+            bool has_default_boundaries() const;
+
+            /**
+             * @brief Get iterations and final residual of the last step
+             *
+             * The residual is the max update for Gauss-Seidel and SOR, the
+             * scaled max residual for multigrid, the relative residual norm
+             * for conjugate gradient and 0 for ADI and spectral.
+             */
+            const StepInfo& get_last_step() const { return last_step_; }
+
+            /**
+             * @brief Set the number of worker threads
+             *
+             * The pool and the spectral transforms, sized by it, are rebuilt
+             * on next use.
+             * @param threads Thread count, 0 for hardware concurrency
+             */
+            void set_threads(int threads);
+
             /**
              * @brief Reset simulation to initial state
              */
             void reset();
     };
+
+    /**
+     * @brief Get display name of a 2D solver method
+     */
+    const char* to_string(HeatEquationSolver2D::Method method);
 }
 
 #endif
\ No newline at end of file
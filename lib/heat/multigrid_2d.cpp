@@ -0,0 +1,305 @@
+#include "multigrid_2d.hpp"
+#include "stencil_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ensiie {
+    namespace {
+        /// Control volume weight of a point, halved on the Neumann side
+        inline double volume(int i) { return i == 0 ? 0.5 : 1.0; }
+    }
+
+    Multigrid2D::Multigrid2D(int n, double r)
+    : pre_smooth_(2)
+    , post_smooth_(2)
+    , coarse_sweeps_(20)
+    , last_residual_(0.0)
+    {
+        // Cells per dimension, halved (rounded up) until the grid is trivial
+        int m = n - 1;
+        double level_r = r;
+
+        while (true) {
+            Level lvl;
+            lvl.n       = m + 1;
+            lvl.r       = level_r;
+            lvl.h_ratio = 1.0;
+            lvl.res.assign(lvl.n * lvl.n, 0.0);
+            if (!levels_.empty()) {
+                lvl.u.assign(lvl.n * lvl.n, 0.0);
+                lvl.rhs.assign(lvl.n * lvl.n, 0.0);
+            }
+            levels_.push_back(lvl);
+
+            if (m <= 2) {
+                break;
+            }
+
+            int m_c = (m + 1) / 2;
+            Level& fine = levels_.back();
+
+            // Fine point i sits at i*m_c/m in coarse grid units
+            fine.coarse_idx.resize(fine.n);
+            fine.coarse_w.resize(fine.n);
+            for (int i = 0; i < fine.n; i++) {
+                long pos = static_cast<long>(i) * m_c;
+                fine.coarse_idx[i] = std::min(static_cast<int>(pos / m), m_c - 1);
+                fine.coarse_w[i]   = static_cast<double>(pos - static_cast<long>(fine.coarse_idx[i]) * m) / m;
+            }
+            fine.h_ratio = static_cast<double>(m_c) / m;
+            fine.tmp.assign(fine.n * (m_c + 1), 0.0);
+
+            level_r *= fine.h_ratio * fine.h_ratio;
+            m = m_c;
+        }
+    }
+
+    void Multigrid2D::set_rate(double r)
+    {
+        // Same rediscretization as the constructor
+        double level_r = r;
+        for (Level& lvl : levels_) {
+            lvl.r = level_r;
+            level_r *= lvl.h_ratio * lvl.h_ratio;
+        }
+    }
+
+    void Multigrid2D::smooth(int l, double* u, const double* rhs, int sweeps, bool reverse) const
+    {
+        const Level& lvl = levels_[l];
+        const int n      = lvl.n;
+        const double r   = lvl.r;
+        const double inv_diag = 1.0 / (1.0 + 4.0 * r);
+        const StencilKernels& kernels = stencil_kernels();
+
+        for (int s = 0; s < sweeps; s++) {
+            for (int pass = 0; pass < 2; pass++) {
+                int color = reverse ? 1 - pass : pass;
+
+                for (int j = 0; j < n - 1; j++) {
+                    // Neumann BC at j=0: mirror row 1
+                    const double* dn = u + (j > 0 ? j - 1 : 1) * n;
+                    const double* up = u + (j + 1) * n;
+                    double* row      = u + j * n;
+                    const double* b  = rhs + j * n;
+
+                    int parity = (color + j) & 1;
+                    if (parity == 0) {
+                        // Neumann BC at i=0: mirror column 1
+                        row[0] = (b[0] + r * (2.0 * row[1] + dn[0] + up[0])) * inv_diag;
+                    }
+                    kernels.relax(dn, row, up, b, 1, n - 1, parity, r, inv_diag, 1.0);
+                }
+            }
+        }
+    }
+
+    double Multigrid2D::residual(int l, const double* u, const double* rhs, double* res) const
+    {
+        const Level& lvl = levels_[l];
+        const int n      = lvl.n;
+        const double r   = lvl.r;
+        const double diag = 1.0 + 4.0 * r;
+        double max_res   = 0.0;
+        const StencilKernels& kernels = stencil_kernels();
+
+        for (int j = 0; j < n - 1; j++) {
+            const double* dn = u + (j > 0 ? j - 1 : 1) * n;
+            const double* up = u + (j + 1) * n;
+            const double* row = u + j * n;
+            const double* b  = rhs + j * n;
+            double* out      = res + j * n;
+
+            out[0] = b[0] - diag * row[0] + r * (2.0 * row[1] + dn[0] + up[0]);
+            max_res = std::max(max_res, std::abs(out[0]));
+            max_res = std::max(max_res, kernels.residual(dn, row, up, b, out, 1, n - 1, diag, r));
+            out[n - 1] = 0.0;
+        }
+        std::fill(res + (n - 1) * n, res + n * n, 0.0);
+
+        return max_res;
+    }
+
+    void Multigrid2D::restrict_to(int l, const double* fine, double* coarse)
+    {
+        // Transpose of the interpolation, weighted by control volumes so
+        // that the Neumann side gets the mirrored full weighting:
+        //   coarse[I] = (h/H) / V[I] * sum_i V[i] * P[i][I] * fine[i]
+        Level& lvl        = levels_[l];
+        const int nf      = lvl.n;
+        const int nc      = levels_[l + 1].n;
+        const int* ci     = lvl.coarse_idx.data();
+        const double* cw  = lvl.coarse_w.data();
+        double* tmp       = lvl.tmp.data();
+
+        // Along i: tmp[j][I], nf rows of nc values
+        std::fill(lvl.tmp.begin(), lvl.tmp.end(), 0.0);
+        for (int j = 0; j < nf - 1; j++) {
+            const double* src = fine + j * nf;
+            double* dst       = tmp + j * nc;
+            for (int i = 0; i < nf - 1; i++) {
+                double v = volume(i) * src[i];
+                dst[ci[i]]     += (1.0 - cw[i]) * v;
+                dst[ci[i] + 1] += cw[i] * v;
+            }
+        }
+
+        // Along j
+        std::fill(coarse, coarse + nc * nc, 0.0);
+        for (int j = 0; j < nf - 1; j++) {
+            double vj = volume(j);
+            double w0 = (1.0 - cw[j]) * vj;
+            double w1 = cw[j] * vj;
+            const double* src = tmp + j * nc;
+            double* dst0 = coarse + ci[j] * nc;
+            double* dst1 = dst0 + nc;
+            for (int I = 0; I < nc - 1; I++) {
+                dst0[I] += w0 * src[I];
+                dst1[I] += w1 * src[I];
+            }
+        }
+
+        double scale = lvl.h_ratio * lvl.h_ratio;
+        for (int J = 0; J < nc; J++) {
+            double* row = coarse + J * nc;
+            if (J == nc - 1) {
+                std::fill(row, row + nc, 0.0);
+                continue;
+            }
+            for (int I = 0; I < nc - 1; I++) {
+                row[I] *= scale / (volume(I) * volume(J));
+            }
+            row[nc - 1] = 0.0;
+        }
+    }
+
+    void Multigrid2D::prolong_add(int l, const double* coarse, double* fine)
+    {
+        Level& lvl        = levels_[l];
+        const int nf      = lvl.n;
+        const int nc      = levels_[l + 1].n;
+        const int* ci     = lvl.coarse_idx.data();
+        const double* cw  = lvl.coarse_w.data();
+        double* tmp       = lvl.tmp.data();
+
+        // Along i: tmp[J][i], nc rows of nf values
+        for (int J = 0; J < nc; J++) {
+            const double* src = coarse + J * nc;
+            double* dst       = tmp + J * nf;
+            for (int i = 0; i < nf - 1; i++) {
+                dst[i] = (1.0 - cw[i]) * src[ci[i]] + cw[i] * src[ci[i] + 1];
+            }
+        }
+
+        // Along j, Dirichlet points are left untouched
+        for (int j = 0; j < nf - 1; j++) {
+            const double* src0 = tmp + ci[j] * nf;
+            const double* src1 = src0 + nf;
+            double w1 = cw[j];
+            double w0 = 1.0 - w1;
+            double* dst = fine + j * nf;
+            for (int i = 0; i < nf - 1; i++) {
+                dst[i] += w0 * src0[i] + w1 * src1[i];
+            }
+        }
+    }
+
+    void Multigrid2D::vcycle(int l, double* u, const double* rhs)
+    {
+        if (l == get_levels() - 1) {
+            smooth(l, u, rhs, coarse_sweeps_, false);
+            return;
+        }
+
+        Level& lvl    = levels_[l];
+        Level& coarse = levels_[l + 1];
+
+        smooth(l, u, rhs, pre_smooth_, false);
+
+        residual(l, u, rhs, lvl.res.data());
+        restrict_to(l, lvl.res.data(), coarse.rhs.data());
+
+        std::fill(coarse.u.begin(), coarse.u.end(), 0.0);
+        vcycle(l + 1, coarse.u.data(), coarse.rhs.data());
+
+        prolong_add(l, coarse.u.data(), u);
+
+        smooth(l, u, rhs, post_smooth_, true);
+    }
+
+    int Multigrid2D::solve(
+        std::vector<double>& u
+        , const std::vector<double>& rhs
+        , double tol
+        , int max_cycles
+    ) {
+        Level& fine = levels_[0];
+        double diag = 1.0 + 4.0 * fine.r;
+
+        last_residual_ = residual(0, u.data(), rhs.data(), fine.res.data()) / diag;
+
+        int cycles = 0;
+        while (cycles < max_cycles && last_residual_ >= tol) {
+            vcycle(0, u.data(), rhs.data());
+            last_residual_ = residual(0, u.data(), rhs.data(), fine.res.data()) / diag;
+            cycles++;
+        }
+
+        return cycles;
+    }
+
+    void Multigrid2D::precondition(const std::vector<double>& res, std::vector<double>& z)
+    {
+        std::fill(z.begin(), z.end(), 0.0);
+        vcycle(0, z.data(), res.data());
+    }
+
+    void Multigrid2D::full_multigrid(
+        std::vector<double>& u
+        , const std::vector<double>& rhs
+        , double boundary
+    ) {
+        const int last = get_levels() - 1;
+
+        // Right hand side on every grid
+        const double* fine_rhs = rhs.data();
+        for (int l = 0; l < last; l++) {
+            restrict_to(l, fine_rhs, levels_[l + 1].rhs.data());
+            fine_rhs = levels_[l + 1].rhs.data();
+        }
+
+        // Solve on the coarsest grid
+        Level& coarsest = levels_[last];
+        std::fill(coarsest.u.begin(), coarsest.u.end(), boundary);
+        if (last == 0) {
+            // Single grid, solve directly in the output
+            u.assign(coarsest.n * coarsest.n, boundary);
+            smooth(0, u.data(), rhs.data(), coarse_sweeps_, false);
+            return;
+        }
+        smooth(last, coarsest.u.data(), coarsest.rhs.data(), coarse_sweeps_, false);
+
+        // Interpolate to the next finer grid and improve with one V-cycle
+        for (int l = last - 1; l >= 0; l--) {
+            Level& lvl = levels_[l];
+            double* ul = (l == 0) ? u.data() : lvl.u.data();
+            const double* bl = (l == 0) ? rhs.data() : lvl.rhs.data();
+
+            if (l == 0) {
+                u.assign(lvl.n * lvl.n, boundary);
+            }
+            for (int j = 0; j < lvl.n; j++) {
+                for (int i = 0; i < lvl.n; i++) {
+                    bool dirichlet = (i == lvl.n - 1 || j == lvl.n - 1);
+                    ul[j * lvl.n + i] = dirichlet ? boundary : 0.0;
+                }
+            }
+            prolong_add(l, levels_[l + 1].u.data(), ul);
+
+            vcycle(l, ul, bl);
+        }
+
+        last_residual_ = residual(0, u.data(), rhs.data(), levels_[0].res.data())
+                         / (1.0 + 4.0 * levels_[0].r);
+    }
+}
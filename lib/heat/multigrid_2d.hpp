@@ -0,0 +1,135 @@
+#ifndef MULTIGRID_2D_HPP
+#define MULTIGRID_2D_HPP
+
+#include <vector>
+
+namespace ensiie {
+    /**
+     * @class Multigrid2D
+     * @brief Geometric multigrid for the 2D implicit heat system
+     *
+     * Solves (1+4r)*u[i,j] - r*(u[i-1,j] + u[i+1,j] + u[i,j-1] + u[i,j+1]) = rhs[i,j]
+     * on an n x n row-major grid with the same boundaries as HeatEquationSolver2D:
+     * - Neumann (mirror) at i=0, j=0
+     * - Dirichlet at i=n-1, j=n-1 (values taken from u and never modified)
+     *
+     * Each coarser level halves the number of cells, rounding up when it
+     * is odd, and rediscretizes the operator with r scaled by (h/H)^2.
+     * Transfers are bilinear interpolation and its weighted transpose,
+     * smoothing is red-black Gauss-Seidel.
+     */
+    class Multigrid2D
+    {
+        private:
+            /**
+             * @brief One grid of the hierarchy
+             */
+            struct Level {
+                int n;                          ///< Points per dimension
+                double r;                       ///< Stencil coefficient κ/h²
+                std::vector<double> u;          ///< Solution/correction (unused on finest)
+                std::vector<double> rhs;        ///< Right hand side (unused on finest)
+                std::vector<double> res;        ///< Residual
+                std::vector<double> tmp;        ///< Buffer for separable transfers to the coarser level
+                std::vector<int> coarse_idx;    ///< Coarse point left of each fine point
+                std::vector<double> coarse_w;   ///< Interpolation weight of coarse_idx + 1
+                double h_ratio;                 ///< h / H with the coarser level
+            };
+
+            std::vector<Level> levels_;         ///< Grids, finest first
+            int pre_smooth_;                    ///< Red-black sweeps before coarse correction
+            int post_smooth_;                   ///< Red-black sweeps after coarse correction
+            int coarse_sweeps_;                 ///< Sweeps on the coarsest grid
+            double last_residual_;              ///< Scaled residual after last solve
+
+            /**
+             * @brief Red-black Gauss-Seidel sweeps on a level
+             * @param reverse Update black points before red ones
+             */
+            void smooth(int l, double* u, const double* rhs, int sweeps, bool reverse) const;
+
+            /**
+             * @brief Compute res = rhs - A*u on a level
+             * @return max |res| over the unknowns
+             */
+            double residual(int l, const double* u, const double* rhs, double* res) const;
+
+            /**
+             * @brief Full weighting of a level l field onto level l+1
+             */
+            void restrict_to(int l, const double* fine, double* coarse);
+
+            /**
+             * @brief Bilinear interpolation of a level l+1 field added to level l
+             */
+            void prolong_add(int l, const double* coarse, double* fine);
+
+            /**
+             * @brief One V-cycle with level l as the finest grid
+             */
+            void vcycle(int l, double* u, const double* rhs);
+
+        public:
+            /**
+             * @brief Build the grid hierarchy
+             * @param n Number of points per dimension on the finest grid
+             * @param r Stencil coefficient α*Δt/Δx² on the finest grid
+             */
+            Multigrid2D(int n, double r);
+
+            /**
+             * @brief Change the stencil coefficient, keeping the grids
+             * @param r Stencil coefficient α*Δt/Δx² on the finest grid
+             */
+            void set_rate(double r);
+
+            /**
+             * @brief Run V-cycles until the residual drops below tol
+             * @param u Initial guess on input, solution on output (n*n)
+             * @param rhs Right hand side (n*n)
+             * @param tol Tolerance on max |rhs - A*u| / (1+4r)
+             * @param max_cycles Maximum number of V-cycles
+             * @return Number of V-cycles done
+             */
+            int solve(
+                std::vector<double>& u
+                , const std::vector<double>& rhs
+                , double tol
+                , int max_cycles
+            );
+
+            /**
+             * @brief Full multigrid solve without initial guess
+             * @param u Solution on output, Dirichlet values are set to boundary
+             * @param rhs Right hand side (n*n)
+             * @param boundary Dirichlet value at i=n-1 and j=n-1
+             */
+            void full_multigrid(
+                std::vector<double>& u
+                , const std::vector<double>& rhs
+                , double boundary
+            );
+
+            /**
+             * @brief Approximate A^-1 * res with one V-cycle from a zero guess
+             *
+             * Pre and post smoothing run in opposite color orders, so the
+             * cycle can precondition a conjugate gradient.
+             * @param res Residual (n*n)
+             * @param z Correction on output (n*n), zero on Dirichlet points
+             */
+            void precondition(const std::vector<double>& res, std::vector<double>& z);
+
+            /**
+             * @brief Get max |rhs - A*u| / (1+4r) after the last solve
+             */
+            double get_last_residual() const { return last_residual_; }
+
+            /**
+             * @brief Get number of grids in the hierarchy
+             */
+            int get_levels() const { return static_cast<int>(levels_.size()); }
+    };
+}
+
+#endif
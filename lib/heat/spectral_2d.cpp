@@ -0,0 +1,99 @@
+#include "spectral_2d.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ensiie {
+    Spectral2D::Spectral2D(int n, int threads)
+    : n_(n)
+    , m_(n - 1)
+    , dct_(n - 1)
+    , mu_(n - 1)
+    , lines_((n - 1) * (n - 1), 0.0)
+    , swap_((n - 1) * (n - 1), 0.0)
+    , work_(threads, std::vector<std::complex<double>>(dct_.workspace_size()))
+    {
+        const double pi = 3.14159265358979323846;
+        for (int k = 0; k < m_; k++) {
+            double s = std::sin(pi * (2 * k + 1) / (4.0 * m_));
+            mu_[k] = 4.0 * s * s;
+        }
+    }
+
+    void Spectral2D::transform_lines(ThreadPool& pool, double* data, bool inverse)
+    {
+        // Lines go by pairs, each pair shares one complex FFT
+        const int pairs = (m_ + 1) / 2;
+
+        pool.parallel_for(0, pairs, [&](int p0, int p1, int worker) {
+            std::complex<double>* work = work_[worker].data();
+            for (int p = p0; p < p1; p++) {
+                double* x = data + 2 * p * m_;
+                if (2 * p + 1 < m_) {
+                    if (inverse) {
+                        dct_.dct2_pair(x, x + m_, work);
+                    } else {
+                        dct_.dct3_pair(x, x + m_, work);
+                    }
+                } else if (inverse) {
+                    dct_.dct2(x, work);
+                } else {
+                    dct_.dct3(x, work);
+                }
+            }
+        });
+    }
+
+    void Spectral2D::transpose(ThreadPool& pool, const double* src, double* dst) const
+    {
+        const int m = m_;
+        const int block = 32;
+        const int n_blocks = (m + block - 1) / block;
+
+        pool.parallel_for(0, n_blocks, [&](int b0, int b1, int) {
+            for (int jb = b0 * block; jb < std::min(m, b1 * block); jb += block) {
+                int j_end = std::min(m, jb + block);
+                for (int ib = 0; ib < m; ib += block) {
+                    int i_end = std::min(m, ib + block);
+                    for (int j = jb; j < j_end; j++) {
+                        for (int i = ib; i < i_end; i++) {
+                            dst[i * m + j] = src[j * m + i];
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    void Spectral2D::forward(ThreadPool& pool, const double* field, double offset, double* coef)
+    {
+        for (int j = 0; j < m_; j++) {
+            for (int i = 0; i < m_; i++) {
+                lines_[j * m_ + i] = field[j * n_ + i] - offset;
+            }
+        }
+
+        // x modes, then y modes on the transposed buffer
+        transform_lines(pool, lines_.data(), false);
+        transpose(pool, lines_.data(), coef);
+        transform_lines(pool, coef, false);
+    }
+
+    void Spectral2D::inverse(ThreadPool& pool, const double* coef, double offset, double* field)
+    {
+        std::copy(coef, coef + m_ * m_, lines_.begin());
+
+        transform_lines(pool, lines_.data(), true);
+        transpose(pool, lines_.data(), swap_.data());
+        transform_lines(pool, swap_.data(), true);
+
+        // Inverse of the DCT-III pair is (2/m)² DCT-II
+        double scale = 4.0 / (static_cast<double>(m_) * m_);
+        for (int j = 0; j < m_; j++) {
+            for (int i = 0; i < m_; i++) {
+                field[j * n_ + i] = offset + scale * swap_[j * m_ + i];
+            }
+            field[j * n_ + m_] = offset;
+        }
+        std::fill(field + m_ * n_, field + n_ * n_, offset);
+    }
+}
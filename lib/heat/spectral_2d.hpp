@@ -0,0 +1,81 @@
+#ifndef SPECTRAL_2D_HPP
+#define SPECTRAL_2D_HPP
+
+#include "cosine_transform.hpp"
+#include "thread_pool.hpp"
+#include <complex>
+#include <vector>
+
+namespace ensiie {
+    /**
+     * @class Spectral2D
+     * @brief Eigenbasis of the 2D Neumann/Dirichlet 5-point Laplacian
+     *
+     * With m = n-1 unknowns per axis, a mirror at index 0 and a zero
+     * Dirichlet value at index m, the 1D operator -δ² has eigenvectors
+     *   v_k[i] = cos(π i (2k+1) / (2m)),  k = 0..m-1
+     * with eigenvalues μ_k = 4 sin²(π (2k+1) / (4m)). The 2D operator is
+     * diagonal in the tensor basis v_k ⊗ v_l with eigenvalue μ_k + μ_l.
+     *
+     * Coefficients are obtained by a DCT-III along each axis and the field
+     * is rebuilt by a DCT-II scaled by (2/m)², both O(n² log n).
+     */
+    class Spectral2D
+    {
+        private:
+            int n_;                         ///< Points per dimension
+            int m_;                         ///< Modes per dimension (n - 1)
+            CosineTransform dct_;           ///< Transform of one line
+            std::vector<double> mu_;        ///< Eigenvalues μ_k of -δ²
+            std::vector<double> lines_;     ///< m x m transform buffer
+            std::vector<double> swap_;      ///< m x m transpose buffer
+            std::vector<std::vector<std::complex<double>>> work_; ///< Per-thread DCT workspace
+
+            /**
+             * @brief Transform every line of an m x m buffer in parallel
+             * @param inverse DCT-II if true, DCT-III otherwise
+             */
+            void transform_lines(ThreadPool& pool, double* data, bool inverse);
+
+            /**
+             * @brief Cache-blocked m x m transpose
+             */
+            void transpose(ThreadPool& pool, const double* src, double* dst) const;
+
+        public:
+            /**
+             * @brief Constructor
+             * @param n Points per dimension, including the Dirichlet one
+             * @param threads Number of threads of the pool used with this object
+             */
+            Spectral2D(int n, int threads);
+
+            /**
+             * @brief Coefficients of (field - offset) in the eigenbasis
+             * @param field n x n row-major field, Dirichlet points equal to offset
+             * @param offset Dirichlet value
+             * @param coef m x m coefficients, x mode major
+             */
+            void forward(ThreadPool& pool, const double* field, double offset, double* coef);
+
+            /**
+             * @brief Rebuild the field from its coefficients
+             * @param coef m x m coefficients, x mode major
+             * @param offset Dirichlet value, added to every point
+             * @param field n x n row-major output
+             */
+            void inverse(ThreadPool& pool, const double* coef, double offset, double* field);
+
+            /**
+             * @brief Get eigenvalue μ_k of the 1D operator -δ²
+             */
+            double eigenvalue(int k) const { return mu_[k]; }
+
+            /**
+             * @brief Get number of modes per dimension
+             */
+            int modes() const { return m_; }
+    };
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include "steady_state.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace ensiie {
+
+    SteadyStateMonitor::SteadyStateMonitor(double tolerance)
+        : tolerance_(tolerance)
+        , time_(0.0) {
+    }
+
+    void SteadyStateMonitor::set_tolerance(double tolerance) {
+        if (!(tolerance > 0.0)) {
+            throw std::invalid_argument("SteadyStateMonitor: tolerance must be positive");
+        }
+        tolerance_ = tolerance;
+    }
+
+    void SteadyStateMonitor::update(double delta, double dt, double t) {
+        double rate = delta / dt;
+        double elapsed = t - time_;
+        time_ = t;
+
+        // Ratio of successive rates over the time between, no estimate while growing
+        state_.decay = (state_.rate > 0.0 && rate > 0.0 && rate < state_.rate && elapsed > 0.0)
+            ? std::log(state_.rate / rate) / elapsed
+            : 0.0;
+        state_.rate = rate;
+
+        if (!state_.reached && rate < tolerance_) {
+            state_.reached = true;
+            state_.equilibrium_time = t;
+        } else if (!state_.reached) {
+            state_.equilibrium_time = (state_.decay > 0.0)
+                ? t + std::log(rate / tolerance_) / state_.decay
+                : std::numeric_limits<double>::infinity();
+        }
+    }
+
+    void SteadyStateMonitor::solved(double distance, double kappa, double t) {
+        time_ = t;
+        state_.reached = true;
+        state_.rate = 0.0;
+        state_.decay = kappa;
+
+        // Rate of the slowest mode: κ * distance * e^{-κτ}
+        double start_rate = kappa * distance;
+        state_.equilibrium_time = (start_rate > tolerance_)
+            ? t + std::log(start_rate / tolerance_) / kappa
+            : t;
+    }
+
+    void SteadyStateMonitor::reset() {
+        time_ = 0.0;
+        state_ = SteadyState{};
+    }
+}
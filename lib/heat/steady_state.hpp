@@ -0,0 +1,80 @@
+#ifndef STEADY_STATE_HPP
+#define STEADY_STATE_HPP
+
+#include <limits>
+
+namespace ensiie {
+
+    /// Default rate below which a field is steady, in K/s
+    constexpr double DEFAULT_STEADY_TOLERANCE = 1e-4;
+
+    /**
+     * @struct SteadyState
+     * @brief Convergence of a run towards its equilibrium
+     */
+    struct SteadyState {
+        bool reached = false;           ///< The rate fell below the tolerance, or the equilibrium was solved for
+        double rate = 0.0;              ///< max |Δu|/Δt of the last step, in K/s
+        double decay = 0.0;             ///< Decay rate of the change in 1/s, 0 while it does not decrease
+        double equilibrium_time = std::numeric_limits<double>::infinity(); ///< Estimated time the rate falls below the tolerance
+    };
+
+    /**
+     * @class SteadyStateMonitor
+     * @brief Follow the step-to-step change of a field towards equilibrium
+     *
+     * Once the sources are balanced by the boundaries, the change decays
+     * as e^{-κt}, κ being the slowest mode of the operator. The decay is
+     * measured from the rates of two successive records, and extrapolated
+     * to the time the rate falls below the tolerance. Neither the rate
+     * nor the estimate depends on the step size.
+     */
+    class SteadyStateMonitor {
+        private:
+            double tolerance_;      ///< Rate of a steady field, in K/s
+            double time_;           ///< Time of the previous record
+            SteadyState state_;
+
+        public:
+            explicit SteadyStateMonitor(double tolerance = DEFAULT_STEADY_TOLERANCE);
+
+            /**
+             * @throws std::invalid_argument unless tolerance > 0
+             */
+            void set_tolerance(double tolerance);
+
+            double get_tolerance() const { return tolerance_; }
+
+            /**
+             * @brief Record a step
+             *
+             * Steps may go unrecorded in between, as with advance(): the
+             * decay is measured over the time since the previous record.
+             * @param delta max |Δu| of the step, in K
+             * @param dt Size of the step
+             * @param t Time after the step
+             */
+            void update(double delta, double dt, double t);
+
+            /**
+             * @brief Record a direct solve of the equilibrium
+             *
+             * The estimate is the time the change from the field it
+             * replaced, decaying at the slowest rate, takes to fall below
+             * the tolerance.
+             * @param distance max |u_eq - u| in K
+             * @param kappa Slowest decay rate of the operator, in 1/s
+             * @param t Time of the replaced field
+             */
+            void solved(double distance, double kappa, double t);
+
+            /**
+             * @brief Forget the run, e.g. on reset
+             */
+            void reset();
+
+            const SteadyState& get_state() const { return state_; }
+    };
+}
+
+#endif
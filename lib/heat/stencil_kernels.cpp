@@ -0,0 +1,586 @@
+#include "stencil_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HEAT_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ensiie {
+    namespace {
+        /// First index of [begin, ...) with the given parity
+        inline int first_of_parity(int begin, int parity) { return begin + ((begin ^ parity) & 1); }
+
+        void apply_scalar(
+            const double* dn, const double* row, const double* up
+            , double* out, int begin, int end, double diag, double r)
+        {
+            for (int i = begin; i < end; i++) {
+                out[i] = diag * row[i] - r * (row[i - 1] + row[i + 1] + dn[i] + up[i]);
+            }
+        }
+
+        double residual_scalar(
+            const double* dn, const double* row, const double* up, const double* b
+            , double* res, int begin, int end, double diag, double r)
+        {
+            double max_res = 0.0;
+            for (int i = begin; i < end; i++) {
+                res[i] = b[i] - diag * row[i] + r * (row[i - 1] + row[i + 1] + dn[i] + up[i]);
+                max_res = std::max(max_res, std::abs(res[i]));
+            }
+            return max_res;
+        }
+
+        double relax_scalar(
+            const double* dn, double* row, const double* up, const double* b
+            , int begin, int end, int parity, double r, double inv_diag, double omega)
+        {
+            double max_diff = 0.0;
+            for (int i = first_of_parity(begin, parity); i < end; i += 2) {
+                double gs = (b[i] + r * (row[i - 1] + row[i + 1] + dn[i] + up[i])) * inv_diag;
+                double delta = omega * (gs - row[i]);
+                row[i] += delta;
+                max_diff = std::max(max_diff, std::abs(delta));
+            }
+            return max_diff;
+        }
+
+        void summarize_scalar(const double* row, double* prev, int begin, int end, RowSummary& acc)
+        {
+            for (int i = begin; i < end; i++) {
+                double v = row[i];
+                acc.min = std::min(acc.min, v);
+                acc.max = std::max(acc.max, v);
+                acc.sum += v;
+                acc.sum_sq += v * v;
+                acc.max_delta = std::max(acc.max_delta, std::abs(v - prev[i]));
+                prev[i] = v;
+            }
+        }
+
+        void thomas_lanes_scalar(
+            double* d, const double* s, const double* a, const double* c_prime
+            , const double* inv_pivot, int n, int lanes)
+        {
+            const std::size_t w = lanes;
+            for (std::size_t l = 0; l < w; l++) {
+                d[l] = (d[l] + s[l]) * inv_pivot[l];
+            }
+            for (std::size_t k = w; k < n * w; k++) {
+                d[k] = (d[k] + s[k] - a[k] * d[k - w]) * inv_pivot[k];
+            }
+            for (std::size_t k = (n - 1) * w; k-- > 0;) {
+                d[k] -= c_prime[k] * d[k + w];
+            }
+        }
+
+        /// Fold the vector lanes of the summarize kernels into acc
+        void merge_lanes(
+            RowSummary& acc, const double* mins, const double* maxs, const double* sums
+            , const double* sqs, const double* deltas, int lanes)
+        {
+            for (int l = 0; l < lanes; l++) {
+                acc.min = std::min(acc.min, mins[l]);
+                acc.max = std::max(acc.max, maxs[l]);
+                acc.sum += sums[l];
+                acc.sum_sq += sqs[l];
+                acc.max_delta = std::max(acc.max_delta, deltas[l]);
+            }
+        }
+
+#ifdef HEAT_SIMD_X86
+        // ---- SSE2 ----
+
+        __attribute__((target("sse2")))
+        double hmax_sse2(__m128d v)
+        {
+            return std::max(_mm_cvtsd_f64(v), _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)));
+        }
+
+        __attribute__((target("sse2")))
+        void apply_sse2(
+            const double* dn, const double* row, const double* up
+            , double* out, int begin, int end, double diag, double r)
+        {
+            const __m128d vd = _mm_set1_pd(diag);
+            const __m128d vr = _mm_set1_pd(r);
+            int i = begin;
+            for (; i + 2 <= end; i += 2) {
+                __m128d nb = _mm_add_pd(_mm_add_pd(_mm_loadu_pd(row + i - 1), _mm_loadu_pd(row + i + 1))
+                                        , _mm_add_pd(_mm_loadu_pd(dn + i), _mm_loadu_pd(up + i)));
+                _mm_storeu_pd(out + i, _mm_sub_pd(_mm_mul_pd(vd, _mm_loadu_pd(row + i)), _mm_mul_pd(vr, nb)));
+            }
+            apply_scalar(dn, row, up, out, i, end, diag, r);
+        }
+
+        __attribute__((target("sse2")))
+        double residual_sse2(
+            const double* dn, const double* row, const double* up, const double* b
+            , double* res, int begin, int end, double diag, double r)
+        {
+            const __m128d vd = _mm_set1_pd(diag);
+            const __m128d vr = _mm_set1_pd(r);
+            const __m128d sign = _mm_set1_pd(-0.0);
+            __m128d vmax = _mm_setzero_pd();
+            int i = begin;
+            for (; i + 2 <= end; i += 2) {
+                __m128d nb = _mm_add_pd(_mm_add_pd(_mm_loadu_pd(row + i - 1), _mm_loadu_pd(row + i + 1))
+                                        , _mm_add_pd(_mm_loadu_pd(dn + i), _mm_loadu_pd(up + i)));
+                __m128d v = _mm_add_pd(_mm_sub_pd(_mm_loadu_pd(b + i), _mm_mul_pd(vd, _mm_loadu_pd(row + i)))
+                                       , _mm_mul_pd(vr, nb));
+                _mm_storeu_pd(res + i, v);
+                vmax = _mm_max_pd(vmax, _mm_andnot_pd(sign, v));
+            }
+            return std::max(hmax_sse2(vmax), residual_scalar(dn, row, up, b, res, i, end, diag, r));
+        }
+
+        __attribute__((target("sse2")))
+        double relax_sse2(
+            const double* dn, double* row, const double* up, const double* b
+            , int begin, int end, int parity, double r, double inv_diag, double omega)
+        {
+            // Two points of one parity per vector, gathered with scalar half loads
+            const __m128d vr = _mm_set1_pd(r);
+            const __m128d vinv = _mm_set1_pd(inv_diag);
+            const __m128d vom = _mm_set1_pd(omega);
+            const __m128d sign = _mm_set1_pd(-0.0);
+            __m128d vmax = _mm_setzero_pd();
+            int i = first_of_parity(begin, parity);
+            for (; i + 3 <= end; i += 4) {
+                __m128d c  = _mm_loadh_pd(_mm_load_sd(row + i), row + i + 2);
+                __m128d lf = _mm_loadh_pd(_mm_load_sd(row + i - 1), row + i + 1);
+                __m128d rt = _mm_loadh_pd(_mm_load_sd(row + i + 1), row + i + 3);
+                __m128d d  = _mm_loadh_pd(_mm_load_sd(dn + i), dn + i + 2);
+                __m128d u  = _mm_loadh_pd(_mm_load_sd(up + i), up + i + 2);
+                __m128d bb = _mm_loadh_pd(_mm_load_sd(b + i), b + i + 2);
+
+                __m128d nb = _mm_add_pd(_mm_add_pd(lf, rt), _mm_add_pd(d, u));
+                __m128d gs = _mm_mul_pd(_mm_add_pd(bb, _mm_mul_pd(vr, nb)), vinv);
+                __m128d delta = _mm_mul_pd(vom, _mm_sub_pd(gs, c));
+                c = _mm_add_pd(c, delta);
+
+                _mm_storel_pd(row + i, c);
+                _mm_storeh_pd(row + i + 2, c);
+                vmax = _mm_max_pd(vmax, _mm_andnot_pd(sign, delta));
+            }
+            return std::max(hmax_sse2(vmax), relax_scalar(dn, row, up, b, i, end, parity, r, inv_diag, omega));
+        }
+
+        __attribute__((target("sse2")))
+        void summarize_sse2(const double* row, double* prev, int begin, int end, RowSummary& acc)
+        {
+            const __m128d sign = _mm_set1_pd(-0.0);
+            __m128d vmin = _mm_set1_pd(acc.min);
+            __m128d vmax = _mm_set1_pd(acc.max);
+            __m128d vsum = _mm_setzero_pd();
+            __m128d vsq  = _mm_setzero_pd();
+            __m128d vdel = _mm_setzero_pd();
+            int i = begin;
+            for (; i + 2 <= end; i += 2) {
+                __m128d v = _mm_loadu_pd(row + i);
+                vmin = _mm_min_pd(vmin, v);
+                vmax = _mm_max_pd(vmax, v);
+                vsum = _mm_add_pd(vsum, v);
+                vsq  = _mm_add_pd(vsq, _mm_mul_pd(v, v));
+                vdel = _mm_max_pd(vdel, _mm_andnot_pd(sign, _mm_sub_pd(v, _mm_loadu_pd(prev + i))));
+                _mm_storeu_pd(prev + i, v);
+            }
+            alignas(16) double lanes[5][2];
+            _mm_store_pd(lanes[0], vmin);
+            _mm_store_pd(lanes[1], vmax);
+            _mm_store_pd(lanes[2], vsum);
+            _mm_store_pd(lanes[3], vsq);
+            _mm_store_pd(lanes[4], vdel);
+            merge_lanes(acc, lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], 2);
+            summarize_scalar(row, prev, i, end, acc);
+        }
+
+        __attribute__((target("sse2")))
+        void thomas_lanes_sse2(
+            double* d, const double* s, const double* a, const double* c_prime
+            , const double* inv_pivot, int n, int lanes)
+        {
+            // 2 systems per vector, lanes being a multiple of 8
+            const std::size_t w = lanes;
+            for (std::size_t l = 0; l < w; l += 2) {
+                __m128d rhs = _mm_add_pd(_mm_loadu_pd(d + l), _mm_loadu_pd(s + l));
+                _mm_storeu_pd(d + l, _mm_mul_pd(rhs, _mm_loadu_pd(inv_pivot + l)));
+            }
+            for (std::size_t k = w; k < n * w; k += 2) {
+                __m128d rhs = _mm_add_pd(_mm_loadu_pd(d + k), _mm_loadu_pd(s + k));
+                rhs = _mm_sub_pd(rhs, _mm_mul_pd(_mm_loadu_pd(a + k), _mm_loadu_pd(d + k - w)));
+                _mm_storeu_pd(d + k, _mm_mul_pd(rhs, _mm_loadu_pd(inv_pivot + k)));
+            }
+            for (std::size_t k = (n - 1) * w; k > 0;) {
+                k -= 2;
+                __m128d x = _mm_loadu_pd(d + k);
+                _mm_storeu_pd(d + k, _mm_sub_pd(x, _mm_mul_pd(_mm_loadu_pd(c_prime + k), _mm_loadu_pd(d + k + w))));
+            }
+        }
+
+        // ---- AVX2 ----
+        //
+        // Scalar tails are SSE code, so the upper register halves are cleared
+        // before them: GCC does not do it before a tail call, and every SSE
+        // instruction would then pay for the dirty AVX state.
+
+        __attribute__((target("avx2,fma")))
+        double hmax_avx2(__m256d v)
+        {
+            __m128d m = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+            return std::max(_mm_cvtsd_f64(m), _mm_cvtsd_f64(_mm_unpackhi_pd(m, m)));
+        }
+
+        __attribute__((target("avx2,fma")))
+        void apply_avx2(
+            const double* dn, const double* row, const double* up
+            , double* out, int begin, int end, double diag, double r)
+        {
+            const __m256d vd = _mm256_set1_pd(diag);
+            const __m256d vr = _mm256_set1_pd(r);
+            int i = begin;
+            for (; i + 4 <= end; i += 4) {
+                __m256d nb = _mm256_add_pd(_mm256_add_pd(_mm256_loadu_pd(row + i - 1), _mm256_loadu_pd(row + i + 1))
+                                           , _mm256_add_pd(_mm256_loadu_pd(dn + i), _mm256_loadu_pd(up + i)));
+                _mm256_storeu_pd(out + i, _mm256_fmsub_pd(vd, _mm256_loadu_pd(row + i), _mm256_mul_pd(vr, nb)));
+            }
+            _mm256_zeroupper();
+            apply_scalar(dn, row, up, out, i, end, diag, r);
+        }
+
+        __attribute__((target("avx2,fma")))
+        double residual_avx2(
+            const double* dn, const double* row, const double* up, const double* b
+            , double* res, int begin, int end, double diag, double r)
+        {
+            const __m256d vd = _mm256_set1_pd(diag);
+            const __m256d vr = _mm256_set1_pd(r);
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            __m256d vmax = _mm256_setzero_pd();
+            int i = begin;
+            for (; i + 4 <= end; i += 4) {
+                __m256d nb = _mm256_add_pd(_mm256_add_pd(_mm256_loadu_pd(row + i - 1), _mm256_loadu_pd(row + i + 1))
+                                           , _mm256_add_pd(_mm256_loadu_pd(dn + i), _mm256_loadu_pd(up + i)));
+                __m256d v = _mm256_fmadd_pd(vr, nb, _mm256_fnmadd_pd(vd, _mm256_loadu_pd(row + i), _mm256_loadu_pd(b + i)));
+                _mm256_storeu_pd(res + i, v);
+                vmax = _mm256_max_pd(vmax, _mm256_andnot_pd(sign, v));
+            }
+            double vector_max = hmax_avx2(vmax);
+            _mm256_zeroupper();
+            return std::max(vector_max, residual_scalar(dn, row, up, b, res, i, end, diag, r));
+        }
+
+        __attribute__((target("avx2,fma")))
+        double relax_avx2(
+            const double* dn, double* row, const double* up, const double* b
+            , int begin, int end, int parity, double r, double inv_diag, double omega)
+        {
+            // Lanes 0 and 2 have the updated parity, lanes 1 and 3 are stored
+            // back unchanged. Left and right neighbours of lanes 0 and 2 are
+            // shuffled from registers: an unaligned load overlapping the
+            // previous store would stall on store forwarding.
+            const __m256d vr = _mm256_set1_pd(r);
+            const __m256d vinv = _mm256_set1_pd(inv_diag);
+            const __m256d vom = _mm256_set1_pd(omega);
+            const __m256d zero = _mm256_setzero_pd();
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            __m256d vmax = zero;
+            int i = first_of_parity(begin, parity);
+            __m256d prev = _mm256_broadcast_sd(row + i - 1);
+            for (; i + 4 <= end; i += 4) {
+                __m256d c     = _mm256_loadu_pd(row + i);
+                __m256d left  = _mm256_permute_pd(_mm256_permute2f128_pd(prev, c, 0x21), 0x5);  // [row[i-1], _, row[i+1], _]
+                __m256d right = _mm256_permute_pd(c, 0x5);                                      // [row[i+1], _, row[i+3], _]
+                __m256d nb = _mm256_add_pd(_mm256_add_pd(left, right)
+                                           , _mm256_add_pd(_mm256_loadu_pd(dn + i), _mm256_loadu_pd(up + i)));
+                __m256d gs = _mm256_mul_pd(_mm256_fmadd_pd(vr, nb, _mm256_loadu_pd(b + i)), vinv);
+                __m256d delta = _mm256_blend_pd(zero, _mm256_mul_pd(vom, _mm256_sub_pd(gs, c)), 0x5);
+                _mm256_storeu_pd(row + i, _mm256_add_pd(c, delta));
+                vmax = _mm256_max_pd(vmax, _mm256_andnot_pd(sign, delta));
+                prev = c;
+            }
+            double vector_max = hmax_avx2(vmax);
+            _mm256_zeroupper();
+            return std::max(vector_max, relax_scalar(dn, row, up, b, i, end, parity, r, inv_diag, omega));
+        }
+
+        __attribute__((target("avx2,fma")))
+        void summarize_avx2(const double* row, double* prev, int begin, int end, RowSummary& acc)
+        {
+            const __m256d sign = _mm256_set1_pd(-0.0);
+            __m256d vmin = _mm256_set1_pd(acc.min);
+            __m256d vmax = _mm256_set1_pd(acc.max);
+            __m256d vsum = _mm256_setzero_pd();
+            __m256d vsq  = _mm256_setzero_pd();
+            __m256d vdel = _mm256_setzero_pd();
+            int i = begin;
+            for (; i + 4 <= end; i += 4) {
+                __m256d v = _mm256_loadu_pd(row + i);
+                vmin = _mm256_min_pd(vmin, v);
+                vmax = _mm256_max_pd(vmax, v);
+                vsum = _mm256_add_pd(vsum, v);
+                vsq  = _mm256_fmadd_pd(v, v, vsq);
+                vdel = _mm256_max_pd(vdel, _mm256_andnot_pd(sign, _mm256_sub_pd(v, _mm256_loadu_pd(prev + i))));
+                _mm256_storeu_pd(prev + i, v);
+            }
+            alignas(32) double lanes[5][4];
+            _mm256_store_pd(lanes[0], vmin);
+            _mm256_store_pd(lanes[1], vmax);
+            _mm256_store_pd(lanes[2], vsum);
+            _mm256_store_pd(lanes[3], vsq);
+            _mm256_store_pd(lanes[4], vdel);
+            _mm256_zeroupper();
+            merge_lanes(acc, lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], 4);
+            summarize_scalar(row, prev, i, end, acc);
+        }
+
+        __attribute__((target("avx2,fma")))
+        void thomas_lanes_avx2(
+            double* d, const double* s, const double* a, const double* c_prime
+            , const double* inv_pivot, int n, int lanes)
+        {
+            // 4 systems per vector, lanes being a multiple of 8
+            const std::size_t w = lanes;
+            for (std::size_t l = 0; l < w; l += 4) {
+                __m256d rhs = _mm256_add_pd(_mm256_loadu_pd(d + l), _mm256_loadu_pd(s + l));
+                _mm256_storeu_pd(d + l, _mm256_mul_pd(rhs, _mm256_loadu_pd(inv_pivot + l)));
+            }
+            for (std::size_t k = w; k < n * w; k += 4) {
+                __m256d rhs = _mm256_add_pd(_mm256_loadu_pd(d + k), _mm256_loadu_pd(s + k));
+                rhs = _mm256_fnmadd_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(d + k - w), rhs);
+                _mm256_storeu_pd(d + k, _mm256_mul_pd(rhs, _mm256_loadu_pd(inv_pivot + k)));
+            }
+            for (std::size_t k = (n - 1) * w; k > 0;) {
+                k -= 4;
+                __m256d x = _mm256_loadu_pd(d + k);
+                _mm256_storeu_pd(d + k, _mm256_fnmadd_pd(_mm256_loadu_pd(c_prime + k), _mm256_loadu_pd(d + k + w), x));
+            }
+            _mm256_zeroupper();
+        }
+
+        // ---- AVX-512 ----
+
+        // Masked forms with an explicit source: the unmasked intrinsics of
+        // GCC 12 start from an "undefined" vector and trip -Wuninitialized
+        __attribute__((target("avx512f")))
+        __m512d max_avx512(__m512d a, __m512d b)
+        {
+            return _mm512_mask_max_pd(a, 0xFF, a, b);
+        }
+
+        __attribute__((target("avx512f")))
+        __m512d min_avx512(__m512d a, __m512d b)
+        {
+            return _mm512_mask_min_pd(a, 0xFF, a, b);
+        }
+
+        __attribute__((target("avx512f")))
+        double hmax_avx512(__m512d v)
+        {
+            alignas(64) double lanes[8];
+            _mm512_store_pd(lanes, v);
+            return *std::max_element(lanes, lanes + 8);
+        }
+
+        __attribute__((target("avx512f")))
+        void apply_avx512(
+            const double* dn, const double* row, const double* up
+            , double* out, int begin, int end, double diag, double r)
+        {
+            const __m512d vd = _mm512_set1_pd(diag);
+            const __m512d vr = _mm512_set1_pd(r);
+            int i = begin;
+            for (; i + 8 <= end; i += 8) {
+                __m512d nb = _mm512_add_pd(_mm512_add_pd(_mm512_loadu_pd(row + i - 1), _mm512_loadu_pd(row + i + 1))
+                                           , _mm512_add_pd(_mm512_loadu_pd(dn + i), _mm512_loadu_pd(up + i)));
+                _mm512_storeu_pd(out + i, _mm512_fmsub_pd(vd, _mm512_loadu_pd(row + i), _mm512_mul_pd(vr, nb)));
+            }
+            _mm256_zeroupper();
+            apply_scalar(dn, row, up, out, i, end, diag, r);
+        }
+
+        __attribute__((target("avx512f")))
+        double residual_avx512(
+            const double* dn, const double* row, const double* up, const double* b
+            , double* res, int begin, int end, double diag, double r)
+        {
+            const __m512d vd = _mm512_set1_pd(diag);
+            const __m512d vr = _mm512_set1_pd(r);
+            __m512d vmax = _mm512_setzero_pd();
+            int i = begin;
+            for (; i + 8 <= end; i += 8) {
+                __m512d nb = _mm512_add_pd(_mm512_add_pd(_mm512_loadu_pd(row + i - 1), _mm512_loadu_pd(row + i + 1))
+                                           , _mm512_add_pd(_mm512_loadu_pd(dn + i), _mm512_loadu_pd(up + i)));
+                __m512d v = _mm512_fmadd_pd(vr, nb, _mm512_fnmadd_pd(vd, _mm512_loadu_pd(row + i), _mm512_loadu_pd(b + i)));
+                _mm512_storeu_pd(res + i, v);
+                vmax = max_avx512(vmax, _mm512_abs_pd(v));
+            }
+            double vector_max = hmax_avx512(vmax);
+            _mm256_zeroupper();
+            return std::max(vector_max, residual_scalar(dn, row, up, b, res, i, end, diag, r));
+        }
+
+        __attribute__((target("avx512f")))
+        double relax_avx512(
+            const double* dn, double* row, const double* up, const double* b
+            , int begin, int end, int parity, double r, double inv_diag, double omega)
+        {
+            // Even lanes have the updated parity, the store is masked to them.
+            // Neighbours are shuffled from registers as in relax_avx2().
+            const __mmask8 lanes = 0x55;
+            const __m512d vr = _mm512_set1_pd(r);
+            const __m512d vinv = _mm512_set1_pd(inv_diag);
+            const __m512d vom = _mm512_set1_pd(omega);
+            __m512d vmax = _mm512_setzero_pd();
+            int i = first_of_parity(begin, parity);
+            __m512d prev = _mm512_set1_pd(row[i - 1]);
+            for (; i + 8 <= end; i += 8) {
+                __m512d c     = _mm512_loadu_pd(row + i);
+                __m512i ci    = _mm512_castpd_si512(c);
+                __m512d left  = _mm512_castsi512_pd(_mm512_mask_alignr_epi64(
+                                    ci, 0xFF, ci, _mm512_castpd_si512(prev), 7));   // [row[i-1], _, row[i+1], ...]
+                __m512d right = _mm512_mask_permute_pd(c, 0xFF, c, 0x55);          // [row[i+1], _, row[i+3], ...]
+                __m512d nb = _mm512_add_pd(_mm512_add_pd(left, right)
+                                           , _mm512_add_pd(_mm512_loadu_pd(dn + i), _mm512_loadu_pd(up + i)));
+                __m512d gs = _mm512_mul_pd(_mm512_fmadd_pd(vr, nb, _mm512_loadu_pd(b + i)), vinv);
+                __m512d delta = _mm512_maskz_mul_pd(lanes, vom, _mm512_sub_pd(gs, c));
+                _mm512_mask_storeu_pd(row + i, lanes, _mm512_add_pd(c, delta));
+                vmax = max_avx512(vmax, _mm512_abs_pd(delta));
+                prev = c;
+            }
+            double vector_max = hmax_avx512(vmax);
+            _mm256_zeroupper();
+            return std::max(vector_max, relax_scalar(dn, row, up, b, i, end, parity, r, inv_diag, omega));
+        }
+
+        __attribute__((target("avx512f")))
+        void summarize_avx512(const double* row, double* prev, int begin, int end, RowSummary& acc)
+        {
+            __m512d vmin = _mm512_set1_pd(acc.min);
+            __m512d vmax = _mm512_set1_pd(acc.max);
+            __m512d vsum = _mm512_setzero_pd();
+            __m512d vsq  = _mm512_setzero_pd();
+            __m512d vdel = _mm512_setzero_pd();
+            int i = begin;
+            for (; i + 8 <= end; i += 8) {
+                __m512d v = _mm512_loadu_pd(row + i);
+                vmin = min_avx512(vmin, v);
+                vmax = max_avx512(vmax, v);
+                vsum = _mm512_add_pd(vsum, v);
+                vsq  = _mm512_fmadd_pd(v, v, vsq);
+                vdel = max_avx512(vdel, _mm512_abs_pd(_mm512_sub_pd(v, _mm512_loadu_pd(prev + i))));
+                _mm512_storeu_pd(prev + i, v);
+            }
+            alignas(64) double lanes[5][8];
+            _mm512_store_pd(lanes[0], vmin);
+            _mm512_store_pd(lanes[1], vmax);
+            _mm512_store_pd(lanes[2], vsum);
+            _mm512_store_pd(lanes[3], vsq);
+            _mm512_store_pd(lanes[4], vdel);
+            _mm256_zeroupper();
+            merge_lanes(acc, lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], 8);
+            summarize_scalar(row, prev, i, end, acc);
+        }
+
+        __attribute__((target("avx512f")))
+        void thomas_lanes_avx512(
+            double* d, const double* s, const double* a, const double* c_prime
+            , const double* inv_pivot, int n, int lanes)
+        {
+            // 8 systems per vector, lanes being a multiple of 8
+            const std::size_t w = lanes;
+            for (std::size_t l = 0; l < w; l += 8) {
+                __m512d rhs = _mm512_add_pd(_mm512_loadu_pd(d + l), _mm512_loadu_pd(s + l));
+                _mm512_storeu_pd(d + l, _mm512_mul_pd(rhs, _mm512_loadu_pd(inv_pivot + l)));
+            }
+            for (std::size_t k = w; k < n * w; k += 8) {
+                __m512d rhs = _mm512_add_pd(_mm512_loadu_pd(d + k), _mm512_loadu_pd(s + k));
+                rhs = _mm512_fnmadd_pd(_mm512_loadu_pd(a + k), _mm512_loadu_pd(d + k - w), rhs);
+                _mm512_storeu_pd(d + k, _mm512_mul_pd(rhs, _mm512_loadu_pd(inv_pivot + k)));
+            }
+            for (std::size_t k = (n - 1) * w; k > 0;) {
+                k -= 8;
+                __m512d x = _mm512_loadu_pd(d + k);
+                _mm512_storeu_pd(d + k, _mm512_fnmadd_pd(_mm512_loadu_pd(c_prime + k), _mm512_loadu_pd(d + k + w), x));
+            }
+        }
+#endif
+
+        const StencilKernels KERNELS[] = {
+            {SimdLevel::SCALAR, apply_scalar, residual_scalar, relax_scalar, summarize_scalar, thomas_lanes_scalar},
+#ifdef HEAT_SIMD_X86
+            {SimdLevel::SSE2,   apply_sse2,   residual_sse2,   relax_sse2,   summarize_sse2,   thomas_lanes_sse2},
+            {SimdLevel::AVX2,   apply_avx2,   residual_avx2,   relax_avx2,   summarize_avx2,   thomas_lanes_avx2},
+            {SimdLevel::AVX512, apply_avx512, residual_avx512, relax_avx512, summarize_avx512, thomas_lanes_avx512},
+#endif
+        };
+
+        /// Best level the hardware can run, ignoring HEAT_SIMD
+        SimdLevel hardware_simd_level()
+        {
+#ifdef HEAT_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return SimdLevel::AVX512;
+            }
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                return SimdLevel::AVX2;
+            }
+            if (__builtin_cpu_supports("sse2")) {
+                return SimdLevel::SSE2;
+            }
+#endif
+            return SimdLevel::SCALAR;
+        }
+    }
+
+    SimdLevel detect_simd_level()
+    {
+        SimdLevel level = hardware_simd_level();
+
+        const char* request = std::getenv("HEAT_SIMD");
+        if (request) {
+            for (SimdLevel l : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+                if (std::strcmp(request, to_string(l)) == 0 && l < level) {
+                    level = l;
+                }
+            }
+        }
+
+        return level;
+    }
+
+    const StencilKernels& stencil_kernels()
+    {
+        static const StencilKernels& kernels = stencil_kernels(detect_simd_level());
+        return kernels;
+    }
+
+    const StencilKernels& stencil_kernels(SimdLevel level)
+    {
+        level = std::min(level, hardware_simd_level());
+
+        const StencilKernels* best = &KERNELS[0];
+        for (const StencilKernels& k : KERNELS) {
+            if (k.level <= level) {
+                best = &k;
+            }
+        }
+        return *best;
+    }
+
+    const char* to_string(SimdLevel level)
+    {
+        switch (level) {
+            case SimdLevel::SCALAR: return "scalar";
+            case SimdLevel::SSE2:   return "sse2";
+            case SimdLevel::AVX2:   return "avx2";
+            case SimdLevel::AVX512: return "avx512";
+        }
+        return "unknown";
+    }
+}
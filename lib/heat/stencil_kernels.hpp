@@ -0,0 +1,117 @@
+#ifndef STENCIL_KERNELS_HPP
+#define STENCIL_KERNELS_HPP
+
+namespace ensiie {
+    /**
+     * @brief Instruction set used by the stencil kernels
+     */
+    enum class SimdLevel {
+        SCALAR,     ///< Portable C++
+        SSE2,       ///< 2 doubles per vector
+        AVX2,       ///< 4 doubles per vector, with FMA
+        AVX512      ///< 8 doubles per vector, with masked stores
+    };
+
+    /**
+     * @struct RowSummary
+     * @brief Running reductions of a field, merged row by row
+     */
+    struct RowSummary {
+        double min;         ///< Start at +infinity
+        double max;         ///< Start at -infinity
+        double sum;
+        double sum_sq;      ///< Sum of squares
+        double max_delta;   ///< max |row[i] - prev[i]|
+    };
+
+    /**
+     * @struct StencilKernels
+     * @brief Row kernels of the 5-point operator A*u = diag*u - r*(left + right + down + up)
+     *
+     * Also the statistics pass and the multi-lane Thomas substitution of
+     * the bar ensemble, dispatched the same way.
+     *
+     * Kernels work on the points [begin, end) of one row, with dn and up the
+     * rows below and above. They read row[begin-1] and row[end], so the
+     * caller peels the mirrored point i=0 and the Dirichlet point i=n-1 out
+     * of the range, which leaves a branch-free loop.
+     */
+    struct StencilKernels {
+        SimdLevel level;    ///< Instruction set of these kernels
+
+        /**
+         * @brief out[i] = diag*row[i] - r*(row[i-1] + row[i+1] + dn[i] + up[i])
+         */
+        void (*apply)(
+            const double* dn, const double* row, const double* up
+            , double* out, int begin, int end, double diag, double r);
+
+        /**
+         * @brief res[i] = b[i] - (A*u)[i]
+         * @return max |res[i]| over the range
+         */
+        double (*residual)(
+            const double* dn, const double* row, const double* up, const double* b
+            , double* res, int begin, int end, double diag, double r);
+
+        /**
+         * @brief Over-relaxed Gauss-Seidel update of the points with (i & 1) == parity
+         *
+         *   row[i] += omega * ((b[i] + r*(neighbours)) * inv_diag - row[i])
+         *
+         * Points of one parity only read points of the other one, so the
+         * update is done on whole vectors and blended back.
+         * @return max |change| over the updated points
+         */
+        double (*relax)(
+            const double* dn, double* row, const double* up, const double* b
+            , int begin, int end, int parity, double r, double inv_diag, double omega);
+
+        /**
+         * @brief Merge the points [begin, end) of a row into acc, then copy them to prev
+         *
+         * One pass gives the statistics of the new field and its change
+         * since prev, and leaves prev ready for the next step.
+         */
+        void (*summarize)(const double* row, double* prev, int begin, int end, RowSummary& acc);
+
+        /**
+         * @brief Thomas substitution of interleaved tridiagonal systems
+         *
+         * Point i of system l is at i*lanes + l, in d, s and the factors:
+         * lower diagonal a, eliminated upper diagonal c' and inverse
+         * pivots. Solves in place with right hand side d + s. A vector
+         * holds the same point of several systems, whose recurrences then
+         * run side by side instead of one dependent chain at a time.
+         * @param lanes Number of systems, a multiple of 8
+         */
+        void (*thomas_lanes)(
+            double* d, const double* s, const double* a, const double* c_prime
+            , const double* inv_pivot, int n, int lanes);
+    };
+
+    /**
+     * @brief Best instruction set supported by this CPU and OS
+     *
+     * The HEAT_SIMD environment variable (scalar, sse2, avx2, avx512) can
+     * lower the level, to compare kernels on the same machine.
+     */
+    SimdLevel detect_simd_level();
+
+    /**
+     * @brief Get kernels for the detected level, chosen once per process
+     */
+    const StencilKernels& stencil_kernels();
+
+    /**
+     * @brief Get kernels for a level, or for the best supported level below it
+     */
+    const StencilKernels& stencil_kernels(SimdLevel level);
+
+    /**
+     * @brief Get display name of an instruction set
+     */
+    const char* to_string(SimdLevel level);
+}
+
+#endif
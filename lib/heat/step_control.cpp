@@ -0,0 +1,57 @@
+#include "step_control.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ensiie {
+    namespace {
+        /// Margin on the predicted step, against the error estimate being low
+        const double SAFETY = 0.9;
+    }
+
+    StepControl::StepControl(double base_dt)
+        : base_dt_(base_dt)
+        , level_(0) {
+    }
+
+    void StepControl::configure(const AdaptiveOptions& options) {
+        if (!(options.tolerance > 0.0) || options.min_level > 0 || options.max_level < 0) {
+            throw std::invalid_argument("StepControl: tolerance must be positive and level 0 within the bounds");
+        }
+        options_ = options;
+        reset();
+    }
+
+    double StepControl::step_size() const {
+        return std::ldexp(base_dt_, level_);
+    }
+
+    bool StepControl::update(double difference, int order, double dt) {
+        double error = difference / (std::ldexp(1.0, order) - 1.0);
+        stats_.last_error = error;
+
+        // Local error goes as h^(p+1): the ideal step is h * factor
+        double factor = (error > 0.0)
+            ? SAFETY * std::pow(options_.tolerance / error, 1.0 / (order + 1))
+            : 2.0;
+
+        if (error > options_.tolerance && level_ > options_.min_level) {
+            int drop = std::max(1, static_cast<int>(std::ceil(-std::log2(factor))));
+            level_ = std::max(options_.min_level, level_ - drop);
+            stats_.rejected++;
+            return false;
+        }
+
+        stats_.accepted++;
+        stats_.last_dt = dt;
+        if (factor >= 2.0 && level_ < options_.max_level) {
+            level_++;
+        }
+        return true;
+    }
+
+    void StepControl::reset() {
+        level_ = 0;
+        stats_ = StepControlStats{};
+    }
+}
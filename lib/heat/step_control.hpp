@@ -0,0 +1,89 @@
+#ifndef STEP_CONTROL_HPP
+#define STEP_CONTROL_HPP
+
+#include <cstdint>
+
+namespace ensiie {
+
+    /**
+     * @struct AdaptiveOptions
+     * @brief Error target and bounds of adaptive time stepping
+     */
+    struct AdaptiveOptions {
+        double tolerance = 0.01;    ///< Largest local error of a step, in K
+        int min_level = -10;        ///< Smallest step is base_dt * 2^min_level
+        int max_level = 8;          ///< Largest step is base_dt * 2^max_level
+    };
+
+    /**
+     * @struct StepControlStats
+     * @brief Counters of an adaptive run
+     */
+    struct StepControlStats {
+        std::uint64_t accepted = 0;     ///< Steps taken
+        std::uint64_t rejected = 0;     ///< Attempts redone with a smaller step
+        double last_error = 0.0;        ///< Error estimate of the last attempt, in K
+        double last_dt = 0.0;           ///< Size of the last accepted step
+    };
+
+    /**
+     * @class StepControl
+     * @brief Step size controller for step doubling
+     *
+     * A step of size h and two steps of h/2 are taken from the same field.
+     * For a method of order p, the half steps are off by about
+     * (u_half - u_full) / (2^p - 1): above the tolerance the attempt is
+     * rejected and redone with a smaller step, well below it the next
+     * step doubles.
+     *
+     * Step sizes are base_dt times a power of two, so the factorizations
+     * and multigrid hierarchies of the solvers, keyed by the rate, are
+     * reused from step to step, and h/2 of one step is h of another.
+     */
+    class StepControl {
+        private:
+            AdaptiveOptions options_;
+            double base_dt_;            ///< Fixed step size, level 0
+            int level_;                 ///< Next step is base_dt * 2^level
+            StepControlStats stats_;
+
+        public:
+            /**
+             * @param base_dt Step size of level 0, the fixed step of the solver
+             */
+            explicit StepControl(double base_dt);
+
+            /**
+             * @brief Set the error target and bounds, back to level 0
+             * @throws std::invalid_argument unless tolerance > 0 and min_level <= 0 <= max_level
+             */
+            void configure(const AdaptiveOptions& options);
+
+            /**
+             * @brief Get the size of the next attempt
+             */
+            double step_size() const;
+
+            /**
+             * @brief Judge an attempt and pick the size of the next one
+             *
+             * At the smallest level the step is accepted whatever its error.
+             * @param difference max |u_half - u_full| in K
+             * @param order Order in time of the method
+             * @param dt Size of the attempt, step_size() or less for the last step
+             * @return true if the step is accepted
+             */
+            bool update(double difference, int order, double dt);
+
+            /**
+             * @brief Back to level 0, counters cleared
+             */
+            void reset();
+
+            double get_base_dt() const { return base_dt_; }
+            const AdaptiveOptions& get_options() const { return options_; }
+            const StepControlStats& get_stats() const { return stats_; }
+    };
+}
+
+#endif
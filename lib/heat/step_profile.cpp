@@ -0,0 +1,33 @@
+#include "step_profile.hpp"
+#include <algorithm>
+
+namespace ensiie {
+
+    double StepRecord::total() const {
+        double sum = 0.0;
+        for (double s : seconds) {
+            sum += s;
+        }
+        return sum;
+    }
+
+    void StepProfile::add(StepRecord record) {
+        record.step = steps;
+        steps++;
+        iterations += record.iterations;
+        max_iterations = std::max(max_iterations, record.iterations);
+        unconverged += record.converged ? 0 : 1;
+        for (int p = 0; p < STEP_PHASES; p++) {
+            seconds[p] += record.seconds[p];
+        }
+        last = record;
+    }
+
+    const char* to_string(StepPhase phase) {
+        switch (phase) {
+            case StepPhase::SOLVE: return "solve";
+            case StepPhase::STATS: return "stats";
+        }
+        return "unknown";
+    }
+}
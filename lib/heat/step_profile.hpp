@@ -0,0 +1,97 @@
+#ifndef STEP_PROFILE_HPP
+#define STEP_PROFILE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace ensiie {
+
+    /**
+     * @brief Timed phases of a solver step
+     */
+    enum class StepPhase {
+        SOLVE,      ///< Right-hand side and linear solve
+        STATS       ///< Field statistics
+    };
+
+    /// Number of StepPhase values
+    constexpr int STEP_PHASES = 2;
+
+    /**
+     * @struct StepRecord
+     * @brief Timings and convergence of one profiled step
+     */
+    struct StepRecord {
+        std::uint64_t step = 0;                         ///< Profiled steps before this one
+        int iterations = 0;                             ///< Sweeps, V-cycles or CG iterations, 0 for direct methods
+        double residual = 0.0;                          ///< Final stopping criterion of the method
+        bool converged = true;                          ///< false if the iteration cap stopped the step
+        std::array<double, STEP_PHASES> seconds{};      ///< Wall time per phase
+
+        double& at(StepPhase phase) { return seconds[static_cast<int>(phase)]; }
+        double at(StepPhase phase) const { return seconds[static_cast<int>(phase)]; }
+
+        /**
+         * @brief Get the wall time of the whole step
+         */
+        double total() const;
+    };
+
+    /**
+     * @struct StepProfile
+     * @brief Totals over the profiled steps, and the last one
+     */
+    struct StepProfile {
+        std::uint64_t steps = 0;                        ///< Profiled steps
+        long long iterations = 0;                       ///< Sum of the iterations
+        int max_iterations = 0;                         ///< Most iterations in one step
+        std::uint64_t unconverged = 0;                  ///< Steps stopped by the iteration cap
+        std::array<double, STEP_PHASES> seconds{};      ///< Wall time per phase
+        StepRecord last;                                ///< Last profiled step
+
+        /**
+         * @brief Add a step, numbering it
+         */
+        void add(StepRecord record);
+    };
+
+    /**
+     * @class ScopedTimer
+     * @brief Add the wall time of a scope to a counter
+     *
+     * A null counter disables it: the clock is not read and the cost is
+     * one branch at each end of the scope.
+     */
+    class ScopedTimer {
+        private:
+            using clock = std::chrono::steady_clock;
+
+            double* target_;
+            clock::time_point start_;
+
+        public:
+            explicit ScopedTimer(double* target)
+                : target_(target) {
+                if (target_) {
+                    start_ = clock::now();
+                }
+            }
+
+            ~ScopedTimer() {
+                if (target_) {
+                    *target_ += std::chrono::duration<double>(clock::now() - start_).count();
+                }
+            }
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+
+    /**
+     * @brief Get display name of a step phase
+     */
+    const char* to_string(StepPhase phase);
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <string>
+
+namespace ensiie {
+    ThreadPool::ThreadPool(int threads)
+    : task_(nullptr)
+    , begin_(0)
+    , end_(0)
+    , generation_(0)
+    , pending_(0)
+    , stop_(false)
+    {
+        if (threads <= 0) {
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        if (threads <= 0) {
+            threads = 1;
+        }
+
+        for (int w = 1; w < threads; w++) {
+            workers_.emplace_back(&ThreadPool::worker_loop, this, w);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+
+        for (std::thread& t : workers_) {
+            t.join();
+        }
+    }
+
+    void ThreadPool::run_block(int worker) const
+    {
+        long count = end_ - begin_;
+        int lo = begin_ + static_cast<int>(count * worker / size());
+        int hi = begin_ + static_cast<int>(count * (worker + 1) / size());
+        if (lo < hi) {
+            (*task_)(lo, hi, worker);
+        }
+    }
+
+    void ThreadPool::worker_loop(int worker)
+    {
+        Tracer::instance().set_thread_name("stencil " + std::to_string(worker));
+        unsigned long seen = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+
+            run_block(worker);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--pending_ == 0) {
+                    done_cv_.notify_one();
+                }
+            }
+        }
+    }
+
+    void ThreadPool::parallel_for(int begin, int end, const RangeFunction& fn)
+    {
+        if (workers_.empty()) {
+            if (begin < end) {
+                fn(begin, end, 0);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_    = &fn;
+            begin_   = begin;
+            end_     = end;
+            pending_ = static_cast<int>(workers_.size());
+            generation_++;
+        }
+        start_cv_.notify_all();
+
+        run_block(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [&] { return pending_ == 0; });
+        task_ = nullptr;
+    }
+}
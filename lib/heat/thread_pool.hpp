@@ -0,0 +1,69 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ensiie {
+    /**
+     * @class ThreadPool
+     * @brief Persistent workers for fork-join loops over index ranges
+     *
+     * The calling thread takes part in every parallel_for() as worker 0,
+     * so a pool of size 1 has no extra thread and runs loops inline.
+     */
+    class ThreadPool
+    {
+        public:
+            /// Loop body called with a block [begin, end) and the worker id
+            using RangeFunction = std::function<void(int begin, int end, int worker)>;
+
+        private:
+            std::vector<std::thread> workers_;  ///< Extra threads (size() - 1)
+            std::mutex mutex_;
+            std::condition_variable start_cv_;  ///< Signals a new loop to workers
+            std::condition_variable done_cv_;   ///< Signals loop completion to caller
+
+            const RangeFunction* task_;         ///< Body of the current loop
+            int begin_;                         ///< Range of the current loop
+            int end_;
+            unsigned long generation_;          ///< Incremented for each loop
+            int pending_;                       ///< Workers still running the loop
+            bool stop_;                         ///< Set on destruction
+
+            /**
+             * @brief Block of [begin_, end_) handled by a worker
+             */
+            void run_block(int worker) const;
+
+            void worker_loop(int worker);
+
+        public:
+            /**
+             * @brief Constructor
+             * @param threads Number of threads, 0 for hardware concurrency
+             */
+            explicit ThreadPool(int threads = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /**
+             * @brief Split [begin, end) in size() contiguous blocks and run them in parallel
+             *
+             * Returns once every block is done, which acts as a barrier.
+             */
+            void parallel_for(int begin, int end, const RangeFunction& fn);
+
+            /**
+             * @brief Get number of threads, including the caller
+             */
+            int size() const { return static_cast<int>(workers_.size()) + 1; }
+    };
+}
+
+#endif
@@ -0,0 +1,251 @@
+#include "trace.hpp"
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+
+namespace ensiie {
+
+    struct Tracer::ThreadBuffer {
+        int tid = -1;                       ///< Assigned on the first event
+        std::uint64_t session = 0;          ///< Trace the events belong to
+        std::vector<TraceEvent> events;
+
+        ~ThreadBuffer() {
+            // Last events of an exiting thread
+            if (!events.empty()) {
+                Tracer::instance().hand_off(*this);
+            }
+        }
+    };
+
+    namespace {
+        /// Spare buffers kept for reuse, the rest are freed
+        const std::size_t MAX_SPARE = 8;
+
+        Tracer::ThreadBuffer& local_buffer() {
+            thread_local Tracer::ThreadBuffer buffer;
+            return buffer;
+        }
+
+        void write_string(std::ostream& out, const std::string& text) {
+            out << '"';
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    out << '\\' << c;
+                } else if (static_cast<unsigned char>(c) >= 0x20) {
+                    out << c;
+                }
+            }
+            out << '"';
+        }
+
+        /**
+         * @brief Write nanoseconds as the microseconds of the format
+         */
+        void write_us(std::ostream& out, std::uint64_t ns) {
+            out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000;
+        }
+    }
+
+    std::atomic<bool> Tracer::enabled_(false);
+
+    Tracer::Tracer()
+        : accepting_(false)
+        , stopping_(false)
+        , session_(0)
+        , next_tid_(1)
+        , epoch_(clock::now())
+        , first_(true) {
+    }
+
+    Tracer::~Tracer() {
+        stop();
+    }
+
+    Tracer& Tracer::instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    void Tracer::start(const std::string& path) {
+        if (writer_.joinable()) {
+            throw std::runtime_error("A trace is already running");
+        }
+        out_.open(path, std::ios::trunc);
+        if (!out_) {
+            throw std::runtime_error("Cannot write trace file " + path);
+        }
+        out_ << "{\"traceEvents\":[\n";
+        first_ = true;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            accepting_ = true;
+            stopping_ = false;
+        }
+        epoch_ = clock::now();
+        session_.fetch_add(1);
+        writer_ = std::thread(&Tracer::write_loop, this);
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    void Tracer::stop() {
+        if (!writer_.joinable()) {
+            return;
+        }
+        enabled_.store(false, std::memory_order_release);
+        flush_thread();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            accepting_ = false;
+            stopping_ = true;
+        }
+        ready_.notify_one();
+        writer_.join();
+
+        // The writer is done, the file is ours
+        for (const auto& name : thread_names_) {
+            out_ << (first_ ? "" : ",\n")
+                 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << name.first
+                 << ",\"args\":{\"name\":";
+            write_string(out_, name.second);
+            out_ << "}}";
+            first_ = false;
+        }
+        out_ << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        out_.close();
+    }
+
+    void Tracer::record(const TraceEvent& event) {
+        ThreadBuffer& buffer = local_buffer();
+        std::uint64_t session = session_.load(std::memory_order_relaxed);
+        if (buffer.tid < 0) {
+            buffer.tid = next_tid_.fetch_add(1);
+            buffer.events.reserve(CHUNK_EVENTS);
+        }
+        if (buffer.session != session) {
+            // Left over from an earlier trace
+            buffer.events.clear();
+            buffer.session = session;
+        }
+        buffer.events.push_back(event);
+        if (buffer.events.size() >= CHUNK_EVENTS) {
+            hand_off(buffer);
+        }
+    }
+
+    void Tracer::instant(const char* name, const char* category, std::initializer_list<TraceArg> args) {
+        if (!enabled()) {
+            return;
+        }
+        Tracer& tracer = instance();
+        TraceEvent event;
+        event.name = name;
+        event.category = category;
+        event.phase = 'i';
+        event.start_ns = tracer.now_ns();
+        int a = 0;
+        for (const TraceArg& arg : args) {
+            if (a == TraceEvent::MAX_ARGS) {
+                break;
+            }
+            event.args[a++] = arg;
+        }
+        tracer.record(event);
+    }
+
+    void Tracer::set_thread_name(const std::string& name) {
+        if (!enabled()) {
+            return;
+        }
+        ThreadBuffer& buffer = local_buffer();
+        if (buffer.tid < 0) {
+            buffer.tid = next_tid_.fetch_add(1);
+            buffer.events.reserve(CHUNK_EVENTS);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread_names_[buffer.tid] = name;
+    }
+
+    void Tracer::flush_thread() {
+        ThreadBuffer& buffer = local_buffer();
+        if (!buffer.events.empty()) {
+            hand_off(buffer);
+        }
+    }
+
+    std::uint64_t Tracer::now_ns() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - epoch_).count();
+    }
+
+    void Tracer::hand_off(ThreadBuffer& buffer) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!accepting_ || buffer.session != session_.load(std::memory_order_relaxed)) {
+            // Stopped meanwhile, or stale
+            buffer.events.clear();
+            return;
+        }
+        full_.push_back(Chunk{buffer.tid, std::move(buffer.events)});
+        if (!spare_.empty()) {
+            buffer.events = std::move(spare_.back());
+            spare_.pop_back();
+        } else {
+            buffer.events = std::vector<TraceEvent>();
+            buffer.events.reserve(CHUNK_EVENTS);
+        }
+        lock.unlock();
+        ready_.notify_one();
+    }
+
+    void Tracer::write_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            ready_.wait(lock, [this] { return !full_.empty() || stopping_; });
+            if (full_.empty()) {
+                break;
+            }
+            Chunk chunk = std::move(full_.front());
+            full_.pop_front();
+            lock.unlock();
+
+            for (const TraceEvent& event : chunk.events) {
+                write_event(chunk.tid, event);
+            }
+            chunk.events.clear();
+
+            lock.lock();
+            if (spare_.size() < MAX_SPARE) {
+                spare_.push_back(std::move(chunk.events));
+            }
+        }
+    }
+
+    void Tracer::write_event(int tid, const TraceEvent& event) {
+        out_ << (first_ ? "" : ",\n") << "{\"name\":\"" << event.name
+             << "\",\"cat\":\"" << (event.category ? event.category : "") << "\",\"ph\":\"" << event.phase
+             << "\",\"ts\":";
+        write_us(out_, event.start_ns);
+        if (event.phase == 'X') {
+            out_ << ",\"dur\":";
+            write_us(out_, event.duration_ns);
+        } else {
+            out_ << ",\"s\":\"t\"";
+        }
+        out_ << ",\"pid\":1,\"tid\":" << tid;
+        first_ = false;
+
+        if (event.args[0].key) {
+            out_ << ",\"args\":{";
+            for (int a = 0; a < TraceEvent::MAX_ARGS && event.args[a].key; a++) {
+                out_ << (a ? "," : "") << '"' << event.args[a].key << "\":";
+                if (std::isfinite(event.args[a].value)) {
+                    out_ << std::setprecision(12) << event.args[a].value;
+                } else {
+                    out_ << "null";
+                }
+            }
+            out_ << '}';
+        }
+        out_ << '}';
+    }
+}
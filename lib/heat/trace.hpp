@@ -0,0 +1,209 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ensiie {
+
+    /**
+     * @struct TraceArg
+     * @brief Named number attached to a trace event
+     */
+    struct TraceArg {
+        const char* key = nullptr;  ///< Static string, e.g. a literal; null for none
+        double value = 0.0;
+    };
+
+    /**
+     * @struct TraceEvent
+     * @brief Span or instant, as recorded by a thread
+     *
+     * Names are not copied: they must be static strings, e.g. literals.
+     */
+    struct TraceEvent {
+        static constexpr int MAX_ARGS = 3;
+
+        const char* name = nullptr;         ///< Event name
+        const char* category = nullptr;     ///< Category, e.g. solver or render
+        char phase = 'X';                   ///< 'X' for a span, 'i' for an instant
+        std::uint64_t start_ns = 0;         ///< Since the start of the trace
+        std::uint64_t duration_ns = 0;      ///< 0 for an instant
+        std::array<TraceArg, MAX_ARGS> args{};
+    };
+
+    /**
+     * @class Tracer
+     * @brief Process-wide Chrome Trace Event recorder
+     *
+     * Each thread appends its events to its own buffer, without lock. A
+     * full buffer of CHUNK_EVENTS events is handed to a writer thread,
+     * which formats the JSON and gets the buffer recycled, so recording
+     * costs a clock read and a copy. A thread's last partial buffer is
+     * handed over when the thread exits, or by stop() for the calling
+     * thread: threads still running at stop() lose it. The file opens in
+     * chrome://tracing or https://ui.perfetto.dev.
+     */
+    class Tracer {
+        public:
+            static constexpr std::size_t CHUNK_EVENTS = 4096;   ///< Events per thread buffer
+
+        private:
+            using clock = std::chrono::steady_clock;
+
+            /// Full buffer of one thread, waiting for the writer
+            struct Chunk {
+                int tid;
+                std::vector<TraceEvent> events;
+            };
+
+            static std::atomic<bool> enabled_;      ///< Read by every span, hence static
+
+            std::mutex mutex_;
+            std::condition_variable ready_;
+            std::deque<Chunk> full_;                    ///< Under mutex_
+            std::vector<std::vector<TraceEvent>> spare_; ///< Emptied buffers, under mutex_
+            std::map<int, std::string> thread_names_;   ///< Under mutex_
+            bool accepting_;                            ///< Under mutex_, false once stopping
+            bool stopping_;                             ///< Under mutex_
+
+            std::atomic<std::uint64_t> session_;    ///< Incremented by each start()
+            std::atomic<int> next_tid_;
+            clock::time_point epoch_;               ///< Start of the trace
+            std::ofstream out_;                     ///< Written by the writer thread only
+            bool first_;                            ///< No event written yet
+            std::thread writer_;
+
+            Tracer();
+
+            /**
+             * @brief Writer thread body: format chunks until stopped
+             */
+            void write_loop();
+
+            void write_event(int tid, const TraceEvent& event);
+
+        public:
+            /// Per-thread buffer, defined with the tracer
+            struct ThreadBuffer;
+
+            ~Tracer();
+
+            Tracer(const Tracer&) = delete;
+            Tracer& operator=(const Tracer&) = delete;
+
+            static Tracer& instance();
+
+            /**
+             * @brief Check whether events are recorded, one relaxed load
+             */
+            static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Open the file and record from now on
+             * @throws std::runtime_error if the file cannot be written or a trace is running
+             */
+            void start(const std::string& path);
+
+            /**
+             * @brief Hand over the calling thread's events, write and close the file
+             *
+             * Does nothing if no trace is running.
+             */
+            void stop();
+
+            /**
+             * @brief Append an event to the calling thread's buffer
+             */
+            void record(const TraceEvent& event);
+
+            /**
+             * @brief Record an instant event, if enabled
+             */
+            static void instant(const char* name, const char* category, std::initializer_list<TraceArg> args = {});
+
+            /**
+             * @brief Name the calling thread in the trace, e.g. "solver"
+             *
+             * Ignored when tracing is off: name threads after start().
+             */
+            void set_thread_name(const std::string& name);
+
+            /**
+             * @brief Hand the calling thread's partial buffer to the writer
+             */
+            void flush_thread();
+
+            /**
+             * @brief Get the time since the start of the trace
+             */
+            std::uint64_t now_ns() const;
+
+            /**
+             * @brief Take a full or last buffer of a thread (internal)
+             */
+            void hand_off(ThreadBuffer& buffer);
+    };
+
+    /**
+     * @class TraceSpan
+     * @brief Record the scope as a span, with up to three arguments
+     *
+     * When tracing is off, construction is one relaxed load and the
+     * other calls return at once.
+     */
+    class TraceSpan {
+        private:
+            TraceEvent event_;
+            int args_;
+            bool active_;
+
+        public:
+            /**
+             * @param name Static string
+             * @param category Static string
+             */
+            TraceSpan(const char* name, const char* category)
+                : args_(0)
+                , active_(Tracer::enabled()) {
+                if (active_) {
+                    event_.name = name;
+                    event_.category = category;
+                    event_.start_ns = Tracer::instance().now_ns();
+                }
+            }
+
+            ~TraceSpan() {
+                if (active_) {
+                    event_.duration_ns = Tracer::instance().now_ns() - event_.start_ns;
+                    Tracer::instance().record(event_);
+                }
+            }
+
+            TraceSpan(const TraceSpan&) = delete;
+            TraceSpan& operator=(const TraceSpan&) = delete;
+
+            /**
+             * @brief Attach a number, ignored past three
+             * @param key Static string
+             */
+            void arg(const char* key, double value) {
+                if (active_ && args_ < TraceEvent::MAX_ARGS) {
+                    event_.args[args_++] = TraceArg{key, value};
+                }
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,237 @@
+#include "tridiagonal_solver.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+
+namespace ensiie {
+    TridiagonalSolver::TridiagonalSolver()
+    : n_(0)
+    , pool_(nullptr)
+    , cyclic_(false)
+    , corner_ratio_(0.0)
+    , correction_scale_(0.0)
+    {
+    }
+
+    void TridiagonalSolver::factorize(
+        const std::vector<double>& a
+        , const std::vector<double>& b
+        , const std::vector<double>& c
+    ) {
+        // Thomas algorithm (TDMA), matrix part of the forward sweep:
+        //   pivot[0] = b[0]
+        //   pivot[i] = b[i] - a[i] * c'[i-1]
+        //   c'[i]    = c[i] / pivot[i]
+        n_ = static_cast<int>(b.size());
+        cyclic_ = false;
+
+        a_ = a;
+        c_prime_.assign(n_, 0.0);
+        inv_pivot_.assign(n_, 0.0);
+        block_begin_.clear();
+        block_end_.clear();
+
+        if (n_ == 0) {
+            return;
+        }
+
+        int blocks = pool_ ? std::min(pool_->size(), n_ / MIN_BLOCK_ROWS) : 1;
+        if (blocks > 1) {
+            partition(b, c, blocks);
+            return;
+        }
+
+        inv_pivot_[0] = 1.0 / b[0];
+        c_prime_[0]   = c[0] * inv_pivot_[0];
+
+        for (int i = 1; i < n_; i++) {
+            inv_pivot_[i] = 1.0 / (b[i] - a[i] * c_prime_[i - 1]);
+            c_prime_[i]   = c[i] * inv_pivot_[i];
+        }
+    }
+
+    void TridiagonalSolver::factorize_cyclic(
+        const std::vector<double>& a
+        , const std::vector<double>& b
+        , const std::vector<double>& c
+    ) {
+        // Sherman-Morrison: A = T + u v^T with u = (γ, 0, ..., 0, c[n-1])
+        // and v = (1, 0, ..., 0, a[0]/γ), T being tridiagonal with
+        //   T[0][0] = b[0] - γ,  T[n-1][n-1] = b[n-1] - c[n-1] a[0] / γ
+        const int n = static_cast<int>(b.size());
+        const double gamma = -b[0];
+
+        std::vector<double> b_mod = b;
+        b_mod[0]     -= gamma;
+        b_mod[n - 1] -= c[n - 1] * a[0] / gamma;
+        factorize(a, b_mod, c);
+
+        z_.assign(n, 0.0);
+        z_[0]     = gamma;
+        z_[n - 1] = c[n - 1];
+        solve(z_);
+
+        corner_ratio_     = a[0] / gamma;
+        correction_scale_ = 1.0 / (1.0 + z_[0] + corner_ratio_ * z_[n - 1]);
+        cyclic_ = true;
+    }
+
+    void TridiagonalSolver::partition(const std::vector<double>& b, const std::vector<double>& c, int blocks)
+    {
+        // Blocks of even sizes, one separator row between two of them
+        const int rows = n_ - (blocks - 1);
+        block_begin_.resize(blocks);
+        block_end_.resize(blocks);
+        int begin = 0;
+        for (int k = 0; k < blocks; k++) {
+            block_begin_[k] = begin;
+            block_end_[k] = begin + rows / blocks + (k < rows % blocks ? 1 : 0);
+            begin = block_end_[k] + 1;
+        }
+
+        // Each block eliminated on its own, then its spikes:
+        //   T w = a[begin] e_first,  T v = c[end-1] e_last
+        // so that x = y - w x[begin-1] - v x[end], T y being the block's right hand side
+        spike_left_.assign(n_, 0.0);
+        spike_right_.assign(n_, 0.0);
+        pool_->parallel_for(0, blocks, [&](int first, int last, int) {
+            for (int k = first; k < last; k++) {
+                const int lo = block_begin_[k];
+                const int hi = block_end_[k];
+                inv_pivot_[lo] = 1.0 / b[lo];
+                c_prime_[lo]   = c[lo] * inv_pivot_[lo];
+                for (int i = lo + 1; i < hi; i++) {
+                    inv_pivot_[i] = 1.0 / (b[i] - a_[i] * c_prime_[i - 1]);
+                    c_prime_[i]   = c[i] * inv_pivot_[i];
+                }
+
+                if (k > 0) {
+                    spike_left_[lo] = a_[lo];
+                    forward(spike_left_.data(), nullptr, lo, hi);
+                    backward(spike_left_.data(), lo, hi);
+                }
+                if (k < blocks - 1) {
+                    spike_right_[hi - 1] = c[hi - 1];
+                    forward(spike_right_.data(), nullptr, lo, hi);
+                    backward(spike_right_.data(), lo, hi);
+                }
+            }
+        });
+
+        // Separator p between blocks j and j+1, with the blocks substituted:
+        //   -a[p] w[p-1] x_prev + (b[p] - a[p] v[p-1] - c[p] w[p+1]) x_p - c[p] v[p+1] x_next
+        //     = d[p] - a[p] y[p-1] - c[p] y[p+1]
+        const int separators = blocks - 1;
+        separator_c_.assign(separators, 0.0);
+        reduced_a_.assign(separators, 0.0);
+        reduced_c_prime_.assign(separators, 0.0);
+        reduced_inv_pivot_.assign(separators, 0.0);
+        double c_prev = 0.0;
+        for (int j = 0; j < separators; j++) {
+            const int p = block_end_[j];
+            double diag = b[p] - a_[p] * spike_right_[p - 1] - c[p] * spike_left_[p + 1];
+            separator_c_[j]       = c[p];
+            reduced_a_[j]         = -a_[p] * spike_left_[p - 1];
+            reduced_inv_pivot_[j] = 1.0 / (diag - reduced_a_[j] * c_prev);
+            reduced_c_prime_[j]   = c_prev = -c[p] * spike_right_[p + 1] * reduced_inv_pivot_[j];
+        }
+    }
+
+    void TridiagonalSolver::forward(double* d, const double* s, int begin, int end) const
+    {
+        if (s) {
+            // Forward on d + s: d'[i] = (d[i] + s[i] - a[i] * d'[i-1]) / pivot[i]
+            d[begin] = (d[begin] + s[begin]) * inv_pivot_[begin];
+            for (int i = begin + 1; i < end; i++) {
+                d[i] = (d[i] + s[i] - a_[i] * d[i - 1]) * inv_pivot_[i];
+            }
+        } else {
+            // Forward: d'[i] = (d[i] - a[i] * d'[i-1]) / pivot[i]
+            d[begin] *= inv_pivot_[begin];
+            for (int i = begin + 1; i < end; i++) {
+                d[i] = (d[i] - a_[i] * d[i - 1]) * inv_pivot_[i];
+            }
+        }
+    }
+
+    void TridiagonalSolver::backward(double* d, int begin, int end) const
+    {
+        // Back sub: x[i] = d'[i] - c'[i] * x[i+1]
+        for (int i = end - 2; i >= begin; --i) {
+            d[i] -= c_prime_[i] * d[i + 1];
+        }
+    }
+
+    void TridiagonalSolver::solve_partitioned(double* d, const double* s) const
+    {
+        const int blocks = static_cast<int>(block_begin_.size());
+
+        // Blocks as if the separators were 0
+        pool_->parallel_for(0, blocks, [&](int first, int last, int) {
+            for (int k = first; k < last; k++) {
+                forward(d, s, block_begin_[k], block_end_[k]);
+                backward(d, block_begin_[k], block_end_[k]);
+            }
+        });
+
+        // Separator system, in place at the separator rows
+        for (int j = 0; j < blocks - 1; j++) {
+            const int p = block_end_[j];
+            double rhs = d[p] + (s ? s[p] : 0.0) - a_[p] * d[p - 1] - separator_c_[j] * d[p + 1];
+            double prev = (j > 0) ? d[block_end_[j - 1]] : 0.0;
+            d[p] = (rhs - reduced_a_[j] * prev) * reduced_inv_pivot_[j];
+        }
+        for (int j = blocks - 3; j >= 0; --j) {
+            d[block_end_[j]] -= reduced_c_prime_[j] * d[block_end_[j + 1]];
+        }
+
+        // Spike correction by the separators on either side
+        pool_->parallel_for(0, blocks, [&](int first, int last, int) {
+            for (int k = first; k < last; k++) {
+                double left  = (k > 0) ? d[block_begin_[k] - 1] : 0.0;
+                double right = (k < blocks - 1) ? d[block_end_[k]] : 0.0;
+                for (int i = block_begin_[k]; i < block_end_[k]; i++) {
+                    d[i] -= spike_left_[i] * left + spike_right_[i] * right;
+                }
+            }
+        });
+    }
+
+    void TridiagonalSolver::solve(double* d) const
+    {
+        substitute(d, nullptr);
+    }
+
+    void TridiagonalSolver::solve(double* d, const double* s) const
+    {
+        substitute(d, s);
+    }
+
+    void TridiagonalSolver::substitute(double* d, const double* s) const
+    {
+        if (n_ == 0) {
+            return;
+        }
+
+        if (block_begin_.empty()) {
+            forward(d, s, 0, n_);
+            backward(d, 0, n_);
+        } else {
+            solve_partitioned(d, s);
+        }
+
+        if (cyclic_) {
+            // x = y - z (v.y) / (1 + v.z)
+            double t = (d[0] + corner_ratio_ * d[n_ - 1]) * correction_scale_;
+            auto correct = [&](int begin, int end, int) {
+                for (int i = begin; i < end; i++) {
+                    d[i] -= t * z_[i];
+                }
+            };
+            if (block_begin_.empty()) {
+                correct(0, n_, 0);
+            } else {
+                pool_->parallel_for(0, n_, correct);
+            }
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#include "work_stealing_pool.hpp"
+#include "trace.hpp"
+#include <string>
+
+namespace ensiie {
+    namespace {
+        /// Pool and deque index of the calling thread, when it is a worker
+        thread_local const WorkStealingPool* current_pool = nullptr;
+        thread_local int current_worker = -1;
+    }
+
+    WorkStealingPool::WorkStealingPool(int threads)
+    : queued_(0)
+    , pending_(0)
+    , next_(0)
+    , stop_(false)
+    {
+        if (threads <= 0) {
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        if (threads <= 0) {
+            threads = 1;
+        }
+
+        for (int w = 0; w < threads; w++) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (int w = 0; w < threads; w++) {
+            workers_.emplace_back(&WorkStealingPool::worker_loop, this, w);
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_cv_.wait(lock, [&] { return pending_.load() == 0; });
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+
+        for (std::thread& t : workers_) {
+            t.join();
+        }
+    }
+
+    WorkStealingPool::Queue& WorkStealingPool::target()
+    {
+        if (current_pool == this) {
+            return *queues_[current_worker];
+        }
+        return *queues_[next_.fetch_add(1, std::memory_order_relaxed) % queues_.size()];
+    }
+
+    void WorkStealingPool::push(Task task, bool front)
+    {
+        pending_.fetch_add(1);
+        Queue& q = target();
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (front) {
+                q.tasks.push_front(std::move(task));
+            } else {
+                q.tasks.push_back(std::move(task));
+            }
+        }
+        queued_.fetch_add(1);
+
+        // Taking the lock orders the increment before a worker's check
+        // and its wait, so the wake-up cannot be lost
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        work_cv_.notify_one();
+    }
+
+    void WorkStealingPool::submit(Task task)
+    {
+        push(std::move(task), false);
+    }
+
+    void WorkStealingPool::defer(Task task)
+    {
+        push(std::move(task), true);
+    }
+
+    bool WorkStealingPool::take(int self, Task& task)
+    {
+        {
+            Queue& own = *queues_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+
+        const int n = static_cast<int>(queues_.size());
+        for (int k = 1; k < n; k++) {
+            Queue& victim = *queues_[(self + k) % n];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::worker_loop(int self)
+    {
+        current_pool = this;
+        current_worker = self;
+        Tracer::instance().set_thread_name("worker " + std::to_string(self));
+
+        Task task;
+        while (true) {
+            if (!take(self, task)) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [&] { return stop_ || queued_.load() > 0; });
+                if (stop_ && queued_.load() == 0) {
+                    return;
+                }
+                continue;
+            }
+
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+            }
+            task = nullptr;
+
+            if (pending_.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_cv_.notify_all();
+            }
+        }
+    }
+
+    void WorkStealingPool::wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [&] { return pending_.load() == 0; });
+
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ensiie {
+    /**
+     * @class WorkStealingPool
+     * @brief Workers running independent tasks from per-worker deques
+     *
+     * Each worker pops its own deque from the back, most recent first, and
+     * an idle worker steals from the front of the others, oldest first.
+     * Tasks submitted from a worker stay on its deque, so spawning needs no
+     * shared lock, and load balances itself whatever the task sizes.
+     * Unlike ThreadPool, which runs fork-join loops inside one solver,
+     * this pool runs whole jobs, such as the runs of a parameter sweep.
+     */
+    class WorkStealingPool
+    {
+        public:
+            using Task = std::function<void()>;
+
+        private:
+            /// Deque of one worker, on its own cache line
+            struct alignas(64) Queue {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+            };
+
+            std::vector<std::unique_ptr<Queue>> queues_;
+            std::vector<std::thread> workers_;
+
+            std::atomic<int> queued_;           ///< Tasks in the deques
+            std::atomic<int> pending_;          ///< Tasks submitted and not finished
+            std::atomic<unsigned> next_;        ///< Round-robin deque for outside submissions
+            bool stop_;                         ///< Set on destruction, under mutex_
+
+            std::mutex mutex_;
+            std::condition_variable work_cv_;   ///< Signals queued tasks to sleeping workers
+            std::condition_variable done_cv_;   ///< Signals pending_ reaching 0
+
+            std::exception_ptr error_;          ///< First exception thrown by a task, under mutex_
+
+            /**
+             * @brief Deque of the calling worker, or a round-robin one from outside
+             */
+            Queue& target();
+
+            void push(Task task, bool front);
+
+            /**
+             * @brief Take a task from the own deque, else steal one
+             */
+            bool take(int self, Task& task);
+
+            void worker_loop(int self);
+
+        public:
+            /**
+             * @brief Constructor
+             * @param threads Number of workers, 0 for hardware concurrency
+             */
+            explicit WorkStealingPool(int threads = 0);
+
+            /**
+             * @brief Wait for the queued tasks, then stop the workers
+             */
+            ~WorkStealingPool();
+
+            WorkStealingPool(const WorkStealingPool&) = delete;
+            WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+            /**
+             * @brief Queue a task, run next by the calling worker
+             */
+            void submit(Task task);
+
+            /**
+             * @brief Queue a task at the steal end of the deque
+             *
+             * Meant for the continuation of a long job: the calling worker
+             * first runs its other tasks, and an idle worker takes the
+             * continuation before anything else it could steal.
+             */
+            void defer(Task task);
+
+            /**
+             * @brief Block until every submitted task, and the ones they submitted, is done
+             * @throws The first exception thrown by a task since the last wait()
+             */
+            void wait();
+
+            /**
+             * @brief Get number of workers
+             */
+            int size() const { return static_cast<int>(workers_.size()); }
+    };
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "colormap.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sdl {
+
+    namespace {
+        // Inferno colormap - scientific visualization colormap
+        // Perceptually uniform, from matplotlib
+        const unsigned char INFERNO_MAP[256][3] = {
+            {0,0,4},{1,0,5},{1,1,6},{1,1,8},{2,1,10},{2,2,12},{2,2,14},{3,2,16},
+            {4,3,18},{4,3,20},{5,4,23},{6,4,25},{7,5,27},{8,5,29},{9,6,32},{10,6,34},
+            {11,7,36},{12,7,39},{13,8,41},{14,8,43},{16,9,46},{17,9,48},{18,10,51},{20,10,53},
+            {21,11,56},{22,11,58},{24,12,61},{25,12,63},{27,12,66},{28,13,68},{30,13,71},{31,13,73},
+            {33,13,76},{35,14,78},{36,14,81},{38,14,83},{40,14,86},{41,14,88},{43,14,91},{45,14,93},
+            {47,14,95},{48,14,98},{50,14,100},{52,14,102},{54,14,105},{56,14,107},{57,14,109},{59,14,111},
+            {61,13,113},{63,13,115},{65,13,117},{67,13,119},{69,13,121},{70,13,123},{72,13,125},{74,12,127},
+            {76,12,128},{78,12,130},{80,12,132},{82,11,133},{84,11,135},{86,11,136},{88,10,138},{90,10,139},
+            {92,10,140},{94,10,142},{96,9,143},{98,9,144},{100,9,145},{102,9,146},{104,9,147},{106,8,148},
+            {108,8,149},{110,8,150},{112,8,151},{114,8,152},{116,8,152},{118,8,153},{120,8,154},{122,8,154},
+            {124,8,155},{126,8,155},{128,8,156},{130,8,156},{132,8,156},{134,9,157},{136,9,157},{138,9,157},
+            {140,10,157},{142,10,157},{144,10,157},{146,11,157},{148,11,157},{150,12,157},{152,12,157},{154,13,157},
+            {156,14,157},{158,14,156},{160,15,156},{162,16,156},{164,17,155},{166,17,155},{168,18,154},{170,19,154},
+            {172,20,153},{174,21,152},{176,22,152},{178,23,151},{180,24,150},{182,25,149},{184,27,148},{186,28,147},
+            {188,29,146},{190,30,145},{192,32,144},{193,33,143},{195,35,142},{197,36,141},{199,38,139},{200,39,138},
+            {202,41,137},{204,43,135},{206,44,134},{207,46,133},{209,48,131},{210,50,130},{212,52,128},{214,54,127},
+            {215,56,125},{217,58,124},{218,60,122},{220,62,121},{221,64,119},{223,66,117},{224,68,116},{226,71,114},
+            {227,73,112},{228,75,111},{230,77,109},{231,79,107},{232,82,105},{234,84,104},{235,86,102},{236,89,100},
+            {237,91,98},{238,93,97},{239,96,95},{240,98,93},{241,100,91},{242,103,89},{243,105,88},{244,108,86},
+            {245,110,84},{246,113,82},{246,115,80},{247,118,79},{248,120,77},{249,123,75},{249,125,73},{250,128,71},
+            {250,130,70},{251,133,68},{252,135,66},{252,138,64},{253,141,62},{253,143,60},{254,146,59},{254,148,57},
+            {254,151,55},{255,153,53},{255,156,51},{255,159,50},{255,161,48},{255,164,46},{255,166,45},{255,169,43},
+            {255,172,41},{255,174,40},{255,177,38},{255,180,37},{255,182,35},{255,185,34},{255,188,32},{255,190,31},
+            {255,193,30},{255,196,29},{255,199,27},{255,201,26},{255,204,25},{255,207,24},{255,210,24},{255,212,23},
+            {255,215,22},{255,218,22},{255,221,21},{255,223,21},{255,226,21},{255,229,21},{255,231,21},{255,234,21},
+            {255,237,22},{255,239,22},{255,242,23},{255,244,24},{255,247,25},{254,249,27},{254,252,28},{252,254,30},
+            {251,255,31},{249,255,33},{248,255,35},{246,255,37},{244,255,39},{243,255,41},{241,255,43},{239,255,46},
+            {238,255,48},{236,255,50},{234,255,53},{232,255,55},{231,255,58},{229,255,60},{227,255,63},{225,255,66},
+            {223,255,68},{222,255,71},{220,255,74},{218,255,77},{216,255,80},{214,255,83},{212,255,86},{210,255,89},
+            {208,255,92},{206,255,95},{204,255,98},{202,255,101},{200,255,104},{198,255,107},{196,255,111},{194,255,114},
+            {192,255,117},{190,255,120},{188,255,124},{186,255,127},{184,255,130},{182,255,134},{180,255,137},{178,255,141},
+            {175,255,144},{173,255,148},{171,255,151},{169,255,155},{167,255,159},{165,255,162},{163,255,166},{252,255,164}
+        };
+
+        /// Viridis and magma, degree 6 polynomial fits of the matplotlib maps per channel
+        const double VIRIDIS_FIT[7][3] = {
+            {0.2777273272234177, 0.005407344544966578, 0.3340998053353061},
+            {0.1050930431085774, 1.404613529898575, 1.384590162594685},
+            {-0.3308618287255563, 0.214847559468213, 0.09509516302823659},
+            {-4.634230498983486, -5.799100973351585, -19.33244095627987},
+            {6.228269936347081, 14.17993336680509, 56.69055260068105},
+            {4.776384997670288, -13.74514537774601, -65.35303263337234},
+            {-5.435455855934631, 4.645852612178535, 26.3124352495832}
+        };
+
+        const double MAGMA_FIT[7][3] = {
+            {-0.002136485053939582, -0.000749655052795221, -0.005386127855323933},
+            {0.2516605407371642, 0.6775232436837668, 2.494026599312351},
+            {8.353717279216625, -3.577719514958484, 0.3144679030132573},
+            {-27.66873308576866, 14.26473078096533, -13.64921318813922},
+            {52.17613981234068, -27.94360607168351, 12.94416944238394},
+            {-50.76852536473588, 29.04658282127291, 4.23415299384598},
+            {18.65570506591883, -11.48977351997711, -5.601961508734096}
+        };
+
+        /// Moreland's cool to warm diverging map, equally spaced control points
+        const unsigned char COOLWARM_MAP[9][3] = {
+            {59,76,192},{98,130,234},{141,176,254},{184,208,249},{221,221,221},
+            {245,196,173},{244,154,123},{222,96,77},{180,4,38}
+        };
+
+        std::uint32_t pack(double r, double g, double b)
+        {
+            auto channel = [](double v) {
+                return static_cast<std::uint32_t>(std::lround(std::max(0.0, std::min(255.0, v))));
+            };
+            return 0xFF000000u | (channel(r) << 16) | (channel(g) << 8) | channel(b);
+        }
+
+        /// Linear interpolation in a table of count RGB entries, x in [0, 1]
+        std::uint32_t sample_table(const unsigned char (*table)[3], int count, double x)
+        {
+            double idx = x * (count - 1);
+            int i0 = std::min(static_cast<int>(idx), count - 2);
+            double frac = idx - i0;
+            return pack(table[i0][0] * (1 - frac) + table[i0 + 1][0] * frac
+                        , table[i0][1] * (1 - frac) + table[i0 + 1][1] * frac
+                        , table[i0][2] * (1 - frac) + table[i0 + 1][2] * frac);
+        }
+
+        /// Horner evaluation of a per-channel polynomial fit, x in [0, 1]
+        std::uint32_t sample_fit(const double (*fit)[3], double x)
+        {
+            double rgb[3];
+            for (int c = 0; c < 3; c++) {
+                double v = fit[6][c];
+                for (int k = 5; k >= 0; k--) {
+                    v = v * x + fit[k][c];
+                }
+                rgb[c] = 255.0 * v;
+            }
+            return pack(rgb[0], rgb[1], rgb[2]);
+        }
+    }
+
+    Colormap::Colormap(Palette palette)
+        : palette_(palette)
+        , lut_(SIZE)
+        , scale_(0.0)
+        , bias_(0.0) {
+        build();
+        set_range(0.0, 1.0);
+    }
+
+    void Colormap::set_palette(Palette palette) {
+        if (palette == palette_) {
+            return;
+        }
+        palette_ = palette;
+        build();
+    }
+
+    void Colormap::set_range(double t_min, double t_max) {
+        // Entry k covers norm in [(k-1/2)/(SIZE-1), (k+1/2)/(SIZE-1)]
+        double width = (t_max > t_min) ? t_max - t_min : 1.0;
+        scale_ = (SIZE - 1) / width;
+        bias_  = 0.5 - t_min * scale_;
+    }
+
+    void Colormap::build() {
+        for (int k = 0; k < SIZE; k++) {
+            double x = static_cast<double>(k) / (SIZE - 1);
+            switch (palette_) {
+                case Palette::INFERNO:  lut_[k] = sample_table(INFERNO_MAP, 256, x);  break;
+                case Palette::VIRIDIS:  lut_[k] = sample_fit(VIRIDIS_FIT, x);         break;
+                case Palette::MAGMA:    lut_[k] = sample_fit(MAGMA_FIT, x);           break;
+                case Palette::COOLWARM: lut_[k] = sample_table(COOLWARM_MAP, 9, x);   break;
+            }
+        }
+    }
+
+    void Colormap::map(const double* t, int count, std::uint32_t* out) const {
+        const double scale = scale_;
+        const double bias  = bias_;
+        const double last  = SIZE - 1;
+        const std::uint32_t* lut = lut_.data();
+
+        // Branch-free: min/max clamps (NaN goes to 0) and one table read
+        for (int i = 0; i < count; i++) {
+            double x = std::min(last, std::max(0.0, t[i] * scale + bias));
+            out[i] = lut[static_cast<int>(x)];
+        }
+    }
+
+    const char* to_string(Palette palette)
+    {
+        switch (palette) {
+            case Palette::INFERNO:  return "Inferno";
+            case Palette::VIRIDIS:  return "Viridis";
+            case Palette::MAGMA:    return "Magma";
+            case Palette::COOLWARM: return "Coolwarm";
+        }
+        return "Unknown";
+    }
+
+}
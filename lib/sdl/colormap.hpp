@@ -0,0 +1,87 @@
+#ifndef COLORMAP_HPP
+#define COLORMAP_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace sdl {
+
+    /**
+     * @brief Color scales offered by Colormap
+     */
+    enum class Palette {
+        INFERNO,    ///< Perceptually uniform, black to yellow
+        VIRIDIS,    ///< Perceptually uniform, blue to yellow
+        MAGMA,      ///< Perceptually uniform, black to pale pink
+        COOLWARM    ///< Diverging, blue to grey to red
+    };
+
+    /**
+     * @class Colormap
+     * @brief Temperature to packed color lookup
+     *
+     * The palette is sampled once into a SIZE entry table of 0xAARRGGBB
+     * colors, so every palette costs the same per sample: one multiply-add,
+     * two clamps and one table read. The range only changes the scale and
+     * bias of the index, not the table.
+     */
+    class Colormap {
+        public:
+            static constexpr int SIZE = 4096;   ///< Table entries
+
+        private:
+            Palette palette_;
+            std::vector<std::uint32_t> lut_;    ///< Packed colors, low to high
+            double scale_;                      ///< Index per unit of temperature
+            double bias_;                       ///< Index of t = 0, plus 1/2 for rounding
+
+            /**
+             * @brief Sample the palette into lut_
+             */
+            void build();
+
+        public:
+            explicit Colormap(Palette palette = Palette::INFERNO);
+
+            /**
+             * @brief Select the palette and rebuild the table
+             */
+            void set_palette(Palette palette);
+
+            /**
+             * @brief Get the selected palette
+             */
+            Palette get_palette() const { return palette_; }
+
+            /**
+             * @brief Set the temperatures mapped to both ends of the palette
+             */
+            void set_range(double t_min, double t_max);
+
+            /**
+             * @brief Convert one temperature
+             */
+            std::uint32_t map(double t) const {
+                double x = t * scale_ + bias_;
+                x = (x > 0.0) ? x : 0.0;
+                x = (x < SIZE - 1) ? x : SIZE - 1;
+                return lut_[static_cast<int>(x)];
+            }
+
+            /**
+             * @brief Convert a run of temperatures in one vectorizable pass
+             * @param t Temperatures
+             * @param count Number of values
+             * @param out Packed colors, count values
+             */
+            void map(const double* t, int count, std::uint32_t* out) const;
+    };
+
+    /**
+     * @brief Get display name of a palette
+     */
+    const char* to_string(Palette palette);
+
+}
+
+#endif
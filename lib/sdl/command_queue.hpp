@@ -0,0 +1,67 @@
+#ifndef COMMAND_QUEUE_HPP
+#define COMMAND_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace sdl {
+
+    /**
+     * @class CommandQueue
+     * @brief Wait-free single producer, single consumer ring buffer
+     *
+     * push() and pop() complete in a bounded number of steps whatever the
+     * other thread does: the producer only writes tail_, the consumer only
+     * writes head_, each on its own cache line.
+     * @tparam T Element type, copied in and out
+     * @tparam N Capacity, a power of two
+     */
+    template <class T, std::size_t N>
+    class CommandQueue {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "CommandQueue capacity must be a power of two");
+
+        private:
+            std::array<T, N> items_;
+            alignas(64) std::atomic<std::size_t> head_;    ///< Next slot to pop
+            alignas(64) std::atomic<std::size_t> tail_;    ///< Next slot to push
+
+        public:
+            CommandQueue()
+                : items_()
+                , head_(0)
+                , tail_(0) {
+            }
+
+            /**
+             * @brief Append an element (producer side)
+             * @return false if the queue is full, the element is dropped
+             */
+            bool push(const T& item) {
+                std::size_t tail = tail_.load(std::memory_order_relaxed);
+                if (tail - head_.load(std::memory_order_acquire) == N) {
+                    return false;
+                }
+                items_[tail & (N - 1)] = item;
+                tail_.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * @brief Remove the oldest element (consumer side)
+             * @return false if the queue is empty
+             */
+            bool pop(T& item) {
+                std::size_t head = head_.load(std::memory_order_relaxed);
+                if (head == tail_.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                item = items_[head & (N - 1)];
+                head_.store(head + 1, std::memory_order_release);
+                return true;
+            }
+    };
+
+}
+
+#endif
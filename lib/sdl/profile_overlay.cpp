@@ -0,0 +1,242 @@
+#include "profile_overlay.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace sdl {
+
+    namespace {
+        /// Bar of a chart, stacked parts from the bottom
+        using Bar = std::array<double, FRAME_PHASES>;
+
+        const SDL_Color TITLE_COLOR = {180, 180, 180, 255};
+        const SDL_Color TEXT_COLOR  = {150, 150, 150, 255};
+        const SDL_Color WARN_COLOR  = {230, 120, 100, 255};
+
+        /// Colors of the parts of a bar, phase order
+        const SDL_Color PHASE_COLORS[FRAME_PHASES] = {
+            {90, 160, 230, 255}
+            , {230, 170, 70, 255}
+            , {120, 200, 120, 255}
+            , {110, 110, 130, 255}
+        };
+
+        const int LINE_HEIGHT = 18;
+        const int CHART_HEIGHT = 36;
+
+        double ms(double seconds) { return seconds * 1e3; }
+
+        /**
+         * @brief Render "title part part..." with each part in its phase color
+         */
+        void render_parts(
+            SDL_Renderer* rend
+            , SDLFont& font
+            , const std::string& title
+            , const std::vector<std::string>& parts
+            , const SDL_Color* colors
+            , int x
+            , int y
+        ) {
+            int w = 0;
+            int h = 0;
+            font.render(rend, title, x, y, TEXT_COLOR);
+            font.get_text_size(title + " ", &w, &h);
+            x += w;
+            for (std::size_t p = 0; p < parts.size(); p++) {
+                font.render(rend, parts[p], x, y, colors[p]);
+                font.get_text_size(parts[p] + " ", &w, &h);
+                x += w;
+            }
+        }
+
+        std::string format_ms(const char* name, double seconds, int precision) {
+            std::ostringstream part;
+            part << name << " " << std::fixed << std::setprecision(precision) << ms(seconds);
+            return part.str();
+        }
+
+        /**
+         * @brief Draw bars scaled to the tallest, the newest on the right
+         */
+        void draw_bars(
+            SDL_Renderer* rend
+            , const std::vector<Bar>& bars
+            , const SDL_Color* colors
+            , int x
+            , int y
+            , int w
+            , int h
+        ) {
+            SDL_SetRenderDrawColor(rend, 25, 25, 32, 255);
+            SDL_Rect frame = {x, y, w, h};
+            SDL_RenderFillRect(rend, &frame);
+
+            double top = 0.0;
+            for (const Bar& bar : bars) {
+                double sum = 0.0;
+                for (double part : bar) {
+                    sum += part;
+                }
+                top = std::max(top, sum);
+            }
+            if (top <= 0.0 || bars.empty()) {
+                return;
+            }
+
+            int bar_w = std::max(1, w / static_cast<int>(ProfileOverlay::HISTORY));
+            int bx = x + w - bar_w * static_cast<int>(bars.size());
+            for (const Bar& bar : bars) {
+                int base = y + h;
+                for (int p = 0; p < FRAME_PHASES; p++) {
+                    int ph = static_cast<int>(bar[p] / top * h + 0.5);
+                    if (ph <= 0) {
+                        continue;
+                    }
+                    SDL_SetRenderDrawColor(rend, colors[p].r, colors[p].g, colors[p].b, 255);
+                    SDL_Rect part = {bx, base - ph, bar_w, ph};
+                    SDL_RenderFillRect(rend, &part);
+                    base -= ph;
+                }
+                bx += bar_w;
+            }
+        }
+    }
+
+    ProfileOverlay::ProfileOverlay()
+        : dropped_(0) {
+    }
+
+    void ProfileOverlay::add_step(const ensiie::StepRecord& record) {
+        if (!steps_.empty()) {
+            std::uint64_t last = steps_.back().step;
+            if (record.step <= last) {
+                // Numbering restarted, the profile was cleared
+                steps_.clear();
+                dropped_ = 0;
+            } else {
+                dropped_ += record.step - last - 1;
+            }
+        }
+        steps_.push(record);
+    }
+
+    void ProfileOverlay::add_frame(const FrameRecord& record) {
+        frames_.push(record);
+    }
+
+    void ProfileOverlay::clear() {
+        steps_.clear();
+        frames_.clear();
+        dropped_ = 0;
+    }
+
+    int ProfileOverlay::draw(
+        SDL_Renderer* rend
+        , SDLFont& font
+        , const ensiie::StepProfile& totals
+        , bool iterative
+        , int x
+        , int y
+        , int w
+    ) {
+        int py = y;
+        font.render(rend, "Profiler", x, py, TITLE_COLOR);
+        py += LINE_HEIGHT + 4;
+
+        // Steps: averages over the window, bars of the phases
+        std::array<double, ensiie::STEP_PHASES> step_sum{};
+        long long iterations = 0;
+        int max_iterations = 0;
+        std::vector<Bar> step_bars;
+        std::vector<Bar> iteration_bars;
+        for (std::size_t k = 0; k < steps_.size(); k++) {
+            const ensiie::StepRecord& r = steps_[k];
+            Bar bar{};
+            for (int p = 0; p < ensiie::STEP_PHASES; p++) {
+                step_sum[p] += r.seconds[p];
+                bar[p] = r.seconds[p];
+            }
+            step_bars.push_back(bar);
+            iterations += r.iterations;
+            max_iterations = std::max(max_iterations, r.iterations);
+
+            // Capped steps in the second color
+            Bar it{};
+            it[r.converged ? 0 : 1] = r.iterations;
+            iteration_bars.push_back(it);
+        }
+        double count = std::max<std::size_t>(steps_.size(), 1);
+
+        std::vector<std::string> step_parts;
+        for (int p = 0; p < ensiie::STEP_PHASES; p++) {
+            step_parts.push_back(format_ms(ensiie::to_string(static_cast<ensiie::StepPhase>(p)), step_sum[p] / count, 3));
+        }
+        render_parts(rend, font, "Step ms", step_parts, PHASE_COLORS, x, py);
+        py += LINE_HEIGHT;
+
+        draw_bars(rend, step_bars, PHASE_COLORS, x, py, w, CHART_HEIGHT);
+        py += CHART_HEIGHT + 6;
+
+        if (iterative) {
+            std::ostringstream it_line;
+            it_line << "Iterations last " << (steps_.empty() ? 0 : steps_.back().iterations)
+                    << ", avg " << std::fixed << std::setprecision(1) << iterations / count
+                    << ", max " << max_iterations;
+            font.render(rend, it_line.str(), x, py, TEXT_COLOR);
+            py += LINE_HEIGHT;
+
+            std::ostringstream cap_line;
+            cap_line << "Capped " << totals.unconverged << " of " << totals.steps << " steps, res "
+                     << std::scientific << std::setprecision(1) << totals.last.residual;
+            font.render(rend, cap_line.str(), x, py, totals.unconverged > 0 ? WARN_COLOR : TEXT_COLOR);
+            py += LINE_HEIGHT;
+
+            const SDL_Color iteration_colors[FRAME_PHASES] = {PHASE_COLORS[0], WARN_COLOR, PHASE_COLORS[2], PHASE_COLORS[3]};
+            draw_bars(rend, iteration_bars, iteration_colors, x, py, w, CHART_HEIGHT);
+            py += CHART_HEIGHT + 6;
+        }
+
+        if (dropped_ > 0) {
+            std::ostringstream drop_line;
+            drop_line << "Dropped " << dropped_ << " steps, UI behind";
+            font.render(rend, drop_line.str(), x, py, WARN_COLOR);
+            py += LINE_HEIGHT;
+        }
+
+        // Frames
+        Bar frame_sum{};
+        std::vector<Bar> frame_bars;
+        for (std::size_t k = 0; k < frames_.size(); k++) {
+            frame_bars.push_back(frames_[k].seconds);
+            for (int p = 0; p < FRAME_PHASES; p++) {
+                frame_sum[p] += frames_[k].seconds[p];
+            }
+        }
+        double frames = std::max<std::size_t>(frames_.size(), 1);
+
+        std::vector<std::string> frame_parts;
+        for (int p = 0; p < FRAME_PHASES; p++) {
+            frame_parts.push_back(format_ms(to_string(static_cast<FramePhase>(p)), frame_sum[p] / frames, 1));
+        }
+        render_parts(rend, font, "Frame ms", frame_parts, PHASE_COLORS, x, py);
+        py += LINE_HEIGHT;
+
+        draw_bars(rend, frame_bars, PHASE_COLORS, x, py, w, CHART_HEIGHT);
+        py += CHART_HEIGHT;
+
+        return py - y;
+    }
+
+    const char* to_string(FramePhase phase) {
+        switch (phase) {
+            case FramePhase::EVENTS:  return "events";
+            case FramePhase::FIELD:   return "field";
+            case FramePhase::PANEL:   return "panel";
+            case FramePhase::PRESENT: return "present";
+        }
+        return "unknown";
+    }
+
+}
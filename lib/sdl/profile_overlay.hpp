@@ -0,0 +1,141 @@
+#ifndef PROFILE_OVERLAY_HPP
+#define PROFILE_OVERLAY_HPP
+
+#include "SDL.h"
+#include "sdl_font.hpp"
+#include "step_profile.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sdl {
+
+    /**
+     * @brief Timed phases of a frame of the UI thread
+     */
+    enum class FramePhase {
+        EVENTS,     ///< Input events and taking the latest snapshot
+        FIELD,      ///< Heatmap, markers and overlays of the field
+        PANEL,      ///< Control panel
+        PRESENT     ///< Present, including the wait for VSYNC
+    };
+
+    /// Number of FramePhase values
+    constexpr int FRAME_PHASES = 4;
+
+    /**
+     * @struct FrameRecord
+     * @brief Wall time of each phase of one frame
+     */
+    struct FrameRecord {
+        std::array<double, FRAME_PHASES> seconds{};
+
+        double& at(FramePhase phase) { return seconds[static_cast<int>(phase)]; }
+        double at(FramePhase phase) const { return seconds[static_cast<int>(phase)]; }
+    };
+
+    /**
+     * @class History
+     * @brief Fixed ring of the last N values, the oldest overwritten
+     * @tparam T Element type, copied in
+     * @tparam N Capacity
+     */
+    template <class T, std::size_t N>
+    class History {
+        private:
+            std::array<T, N> items_;
+            std::size_t next_;      ///< Slot of the next value
+            std::size_t count_;     ///< Values held, at most N
+
+        public:
+            History()
+                : items_()
+                , next_(0)
+                , count_(0) {
+            }
+
+            void push(const T& item) {
+                items_[next_] = item;
+                next_ = (next_ + 1) % N;
+                count_ = (count_ < N) ? count_ + 1 : N;
+            }
+
+            void clear() {
+                next_ = 0;
+                count_ = 0;
+            }
+
+            std::size_t size() const { return count_; }
+            bool empty() const { return count_ == 0; }
+
+            /**
+             * @brief Get the k-th value held, oldest first
+             */
+            const T& operator[](std::size_t k) const { return items_[(next_ + N - count_ + k) % N]; }
+
+            /**
+             * @brief Get the newest value, the history must not be empty
+             */
+            const T& back() const { return items_[(next_ + N - 1) % N]; }
+    };
+
+    /**
+     * @class ProfileOverlay
+     * @brief Recent step and frame timings, drawn as text and bar charts
+     *
+     * Keeps the last HISTORY steps, as drained from the solver thread's
+     * ring, and the last HISTORY frames. Averages and charts cover that
+     * window; the iteration cap count covers the whole profiled run.
+     */
+    class ProfileOverlay {
+        public:
+            static constexpr std::size_t HISTORY = 120;     ///< Steps and frames kept
+
+        private:
+            History<ensiie::StepRecord, HISTORY> steps_;
+            History<FrameRecord, HISTORY> frames_;
+            std::uint64_t dropped_;     ///< Steps missing from the ring, it was full
+
+        public:
+            ProfileOverlay();
+
+            /**
+             * @brief Record a step taken from the solver thread
+             */
+            void add_step(const ensiie::StepRecord& record);
+
+            /**
+             * @brief Record a frame of the UI thread
+             */
+            void add_frame(const FrameRecord& record);
+
+            /**
+             * @brief Forget the history, e.g. on reset
+             */
+            void clear();
+
+            /**
+             * @brief Draw the overlay
+             * @param totals Profile of the run, from the latest snapshot
+             * @param iterative The method iterates, iterations are shown
+             * @return Height used
+             */
+            int draw(
+                SDL_Renderer* rend
+                , SDLFont& font
+                , const ensiie::StepProfile& totals
+                , bool iterative
+                , int x
+                , int y
+                , int w
+            );
+    };
+
+    /**
+     * @brief Get display name of a frame phase
+     */
+    const char* to_string(FramePhase phase);
+
+}
+
+#endif
@@ -1,8 +1,10 @@
 #include "sdl_app.hpp"
 #include "sdl_core.hpp"
+#include "trace.hpp"
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <cstdlib>
 
 #ifdef __APPLE__
     static const char* FONT_PATH = "/System/Library/Fonts/Helvetica.ttc";
@@ -21,14 +23,14 @@ namespace sdl {
         , label_font_(std::make_unique<SDLFont>(FONT_PATH, 18))
         , button_font_(std::make_unique<SDLFont>(FONT_PATH, 22))
         , small_font_(std::make_unique<SDLFont>(FONT_PATH, 16))
-        , solver_1d_(nullptr)
-        , solver_2d_(nullptr)
+        , simulation_(nullptr)
         , mode_(Mode::MENU)
         , sim_type_(SimType::BAR_1D)
         , material_(ensiie::Materials::COPPER)
         , selected_sim_type_(0)
         , selected_material_(0)
         , dragging_slider_(-1)
+        , method_2d_(ensiie::HeatEquationSolver2D::Method::GAUSS_SEIDEL)
         , L_(1.0)
         , tmax_(16.0)
         , u0_(13.0)
@@ -37,6 +39,7 @@ namespace sdl {
         , paused_(false)
         , speed_(10)
         , running_(true)
+        , profiling_(false)
         , panel_x_(0)
         , panel_y_(0)
         , panel_w_(0)
@@ -158,21 +161,64 @@ namespace sdl {
                 break;
             case 4:
                 if (sim_type_ == SimType::BAR_1D) {
-                    n_ = 101 + static_cast<int>(ratio * 1900);
+                    n_ = 101 + static_cast<int>(ratio * (grid_max() - 101));
                 } else {
-                    n_ = 51 + static_cast<int>(ratio * 150);
+                    n_ = 51 + static_cast<int>(ratio * (grid_max() - 51));
                 }
                 break;
         }
     }
 
+    int SDLApp::grid_max() const {
+        if (sim_type_ == SimType::BAR_1D) {
+            return 2001;
+        }
+        // The faster methods make larger plates usable, the banded
+        // factor needs n³ doubles
+        switch (method_2d_) {
+            case ensiie::HeatEquationSolver2D::Method::GAUSS_SEIDEL:
+            case ensiie::HeatEquationSolver2D::Method::CHOLESKY:
+                return 201;
+            default:
+                return 1001;
+        }
+    }
+
+    void SDLApp::cycle_method_2d() {
+        using Method = ensiie::HeatEquationSolver2D::Method;
+        switch (method_2d_) {
+            case Method::GAUSS_SEIDEL:  method_2d_ = Method::MULTIGRID;     break;
+            case Method::MULTIGRID:     method_2d_ = Method::RED_BLACK_SOR; break;
+            case Method::RED_BLACK_SOR: method_2d_ = Method::ADI;           break;
+            case Method::ADI:           method_2d_ = Method::SPECTRAL;      break;
+            case Method::SPECTRAL:      method_2d_ = Method::CONJUGATE_GRADIENT; break;
+            case Method::CONJUGATE_GRADIENT: method_2d_ = Method::CHOLESKY; break;
+            case Method::CHOLESKY:      method_2d_ = Method::GAUSS_SEIDEL;  break;
+        }
+        if (sim_type_ == SimType::PLATE_2D) {
+            n_ = std::min(n_, grid_max());
+        }
+    }
+
+    void SDLApp::cycle_palette() {
+        switch (heatmap_->get_palette()) {
+            case Palette::INFERNO:  heatmap_->set_palette(Palette::VIRIDIS);  break;
+            case Palette::VIRIDIS:  heatmap_->set_palette(Palette::MAGMA);    break;
+            case Palette::MAGMA:    heatmap_->set_palette(Palette::COOLWARM); break;
+            case Palette::COOLWARM: heatmap_->set_palette(Palette::INFERNO);  break;
+        }
+    }
+
     void SDLApp::start_simulation() {
         mode_ = Mode::SIMULATION;
         paused_ = false;
 
+        // Join the previous solver thread before building the next solver
+        simulation_.reset();
+
         if (sim_type_ == SimType::BAR_1D) {
             speed_ = 10;
-            solver_1d_ = std::make_unique<ensiie::HeatEquationSolver1D>(
+            auto solver = std::make_unique<ensiie::HeatEquationSolver1D>(
                 material_
                 , L_
                 , tmax_
@@ -180,25 +226,64 @@ namespace sdl {
                 , f_
                 , n_
             );
-            solver_2d_.reset();
+            simulation_ = std::make_unique<SimulationThread>(std::move(solver), speed_, tmax_);
         } else {
             speed_ = 5;
-            solver_2d_ = std::make_unique<ensiie::HeatEquationSolver2D>(
+            auto solver = std::make_unique<ensiie::HeatEquationSolver2D>(
                 material_
                 , L_
                 , tmax_
                 , u0_
                 , f_
                 , n_
+                , method_2d_
             );
-            solver_1d_.reset();
+            simulation_ = std::make_unique<SimulationThread>(std::move(solver), speed_, tmax_);
+        }
+
+        profile_overlay_.clear();
+        if (profiling_) {
+            simulation_->send(SimulationCommand::Type::SET_PROFILING, 1.0);
         }
     }
 
     void SDLApp::stop_simulation() {
         mode_ = Mode::MENU;
-        solver_1d_.reset();
-        solver_2d_.reset();
+        simulation_.reset();
+    }
+
+    void SDLApp::set_paused(bool paused) {
+        paused_ = paused;
+        if (simulation_) {
+            simulation_->send(SimulationCommand::Type::SET_PAUSED, paused ? 1.0 : 0.0);
+        }
+    }
+
+    void SDLApp::change_speed(int delta) {
+        if (sim_type_ == SimType::BAR_1D) {
+            speed_ = std::max(1, std::min(50, speed_ + 5 * delta));
+        } else {
+            speed_ = std::max(1, std::min(20, speed_ + 2 * delta));
+        }
+        if (simulation_) {
+            simulation_->send(SimulationCommand::Type::SET_SPEED, speed_);
+        }
+    }
+
+    void SDLApp::reset_simulation() {
+        paused_ = false;
+        if (simulation_) {
+            simulation_->send(SimulationCommand::Type::RESET);
+        }
+    }
+
+    void SDLApp::set_profiling(bool enabled) {
+        profiling_ = enabled;
+        profile_overlay_.clear();
+        frame_ = FrameRecord{};
+        if (simulation_) {
+            simulation_->send(SimulationCommand::Type::SET_PROFILING, enabled ? 1.0 : 0.0);
+        }
     }
 
     void SDLApp::render_menu() {
@@ -248,7 +333,7 @@ namespace sdl {
             ? "Grid Points n" : "Grid Points n (per axis)";
         draw_slider(grid_label, static_cast<double>(n_),
             (sim_type_ == SimType::BAR_1D) ? 101.0 : 51.0,
-            (sim_type_ == SimType::BAR_1D) ? 2001.0 : 201.0,
+            static_cast<double>(grid_max()),
             panel_x, y + 220, slider_w);
 
         y += 290;
@@ -258,6 +343,9 @@ namespace sdl {
         std::ostringstream info;
         info << "Material: " << material_.name
              << " | alpha = " << std::fixed << std::setprecision(6) << material_.alpha() << " m2/s";
+        if (sim_type_ == SimType::PLATE_2D) {
+            info << " | Solver: " << ensiie::to_string(method_2d_);
+        }
         small_font_->render(rend, info.str(), panel_x + 10, y + 10, {180, 180, 180, 255});
 
         std::ostringstream info2;
@@ -271,7 +359,7 @@ namespace sdl {
         int btn_x = (w - btn_w) / 2;
         draw_text_box("START SIMULATION", btn_x, y, btn_w, 50, false);
 
-        small_font_->render(rend, "Press SPACE or ENTER to start | ESC to quit", panel_x + 120, h - 30, {120, 120, 120, 255});
+        small_font_->render(rend, "Press SPACE or ENTER to start | B: 2D solver | C: colors | ESC to quit", panel_x + 80, h - 30, {120, 120, 120, 255});
 
         window_->present();
     }
@@ -379,41 +467,28 @@ namespace sdl {
         draw_rect(px, py, pw - 30, 35, 180, 100, 80, true);
         draw_rect(px, py, pw - 30, 35, 100, 100, 120, false);
         button_font_->render_centered(rend, "MENU", px, py, pw - 30, 35, {255, 255, 255, 255});
+        py += 50;
+
+        if (profiling_ && simulation_) {
+            using Method = ensiie::HeatEquationSolver2D::Method;
+            const SimulationSnapshot& snap = simulation_->snapshot();
+            bool iterative = sim_type_ == SimType::PLATE_2D
+                && (snap.method == Method::GAUSS_SEIDEL || snap.method == Method::MULTIGRID
+                    || snap.method == Method::RED_BLACK_SOR || snap.method == Method::CONJUGATE_GRADIENT);
+
+            draw_rect(px, py, pw - 30, 2, 60, 60, 70, true);
+            py += 10;
+            profile_overlay_.draw(rend, *small_font_, snap.profile, iterative, px, py, pw - 30);
+        }
     }
 
-    void SDLApp::render_simulation() {
-        window_->clear(25, 25, 30);
+    void SDLApp::render_field(const SimulationSnapshot& snap, int vis_w, int h) {
         SDL_Renderer* rend = window_->get_renderer();
 
-        int w = window_->get_width();
-        int h = window_->get_height();
-
-        int vis_w = static_cast<int>(w * 0.70);
-        panel_w_ = w - vis_w - 20;
-        panel_x_ = vis_w + 10;
-        panel_y_ = 10;
-        panel_h_ = h - 20;
-
-        double current_time = 0.0;
-
-        draw_rect(5, 5, vis_w - 10, h - 10, 30, 30, 35, true);
-        draw_rect(5, 5, vis_w - 10, h - 10, 50, 50, 60, false);
-
-        std::string sim_title = (sim_type_ == SimType::BAR_1D)
-            ? "1D Heat Equation - Bar"
-            : "2D Heat Equation - Plate";
-        title_font_->render(rend, sim_title, 20, 15, {255, 255, 255, 255});
-
-        std::ostringstream mat_info;
-        mat_info << "Material: " << material_.name
-                 << " | alpha = " << std::fixed << std::setprecision(6) << material_.alpha() << " m2/s";
-        small_font_->render(rend, mat_info.str(), 20, 50, {180, 180, 180, 255});
-
-        if (sim_type_ == SimType::BAR_1D && solver_1d_) {
-            current_time = solver_1d_->get_time();
-            auto temps = solver_1d_->get_temperature();
+        if (sim_type_ == SimType::BAR_1D) {
+            ensiie::FieldView temps = snap.field();
             if (!temps.empty()) {
-                heatmap_->auto_range(temps);
+                heatmap_->auto_range(snap.stats);
 
                 int bar_x = 20;
                 int bar_y = 90;
@@ -436,14 +511,13 @@ namespace sdl {
 
                 int stats_w = 360;
                 int stats_x = bar_x + (bar_w - stats_w) / 2;
-                heatmap_->draw_stats(temps, stats_x, 70);
+                heatmap_->draw_stats(snap.stats, stats_x, 70);
             }
 
-        } else if (sim_type_ == SimType::PLATE_2D && solver_2d_) {
-            current_time = solver_2d_->get_time();
-            auto temps = solver_2d_->get_temperature_2d();
-            if (!temps.empty() && !temps[0].empty()) {
-                heatmap_->auto_range_2d(temps);
+        } else if (sim_type_ == SimType::PLATE_2D) {
+            ensiie::FieldView temps = snap.field();
+            if (!temps.empty()) {
+                heatmap_->auto_range(snap.stats);
 
                 int plate_x = 20;
                 int plate_y = 80;
@@ -465,13 +539,62 @@ namespace sdl {
 
                 int stats_w = 360;
                 int stats_x = plate_x + (plate_size - stats_w) / 2;
-                heatmap_->draw_stats_2d(temps, stats_x, 60);
+                heatmap_->draw_stats(snap.stats, stats_x, 60);
             }
         }
+    }
 
-        render_sim_control_panel(panel_x_, panel_y_, panel_w_, panel_h_, current_time);
+    void SDLApp::render_simulation() {
+        window_->clear(25, 25, 30);
+        SDL_Renderer* rend = window_->get_renderer();
 
-        window_->present();
+        int w = window_->get_width();
+        int h = window_->get_height();
+
+        int vis_w = static_cast<int>(w * 0.70);
+        panel_w_ = w - vis_w - 20;
+        panel_x_ = vis_w + 10;
+        panel_y_ = 10;
+        panel_h_ = h - 20;
+
+        const SimulationSnapshot* snap = simulation_ ? &simulation_->snapshot() : nullptr;
+        double current_time = 0.0;
+
+        draw_rect(5, 5, vis_w - 10, h - 10, 30, 30, 35, true);
+        draw_rect(5, 5, vis_w - 10, h - 10, 50, 50, 60, false);
+
+        std::string sim_title = (sim_type_ == SimType::BAR_1D)
+            ? "1D Heat Equation - Bar"
+            : "2D Heat Equation - Plate";
+        title_font_->render(rend, sim_title, 20, 15, {255, 255, 255, 255});
+
+        std::ostringstream mat_info;
+        mat_info << "Material: " << material_.name
+                 << " | alpha = " << std::fixed << std::setprecision(6) << material_.alpha() << " m2/s"
+                 << " | " << to_string(heatmap_->get_palette());
+        if (sim_type_ == SimType::PLATE_2D && snap) {
+            const auto& last = snap->last_step;
+            mat_info << " | " << ensiie::to_string(snap->method)
+                     << ": " << last.iterations << " it, res "
+                     << std::scientific << std::setprecision(1) << last.residual;
+        }
+        small_font_->render(rend, mat_info.str(), 20, 50, {180, 180, 180, 255});
+
+        if (snap) {
+            current_time = snap->time;
+            ensiie::ScopedTimer timer(frame_timer(FramePhase::FIELD));
+            render_field(*snap, vis_w, h);
+        }
+
+        {
+            ensiie::ScopedTimer timer(frame_timer(FramePhase::PANEL));
+            render_sim_control_panel(panel_x_, panel_y_, panel_w_, panel_h_, current_time);
+        }
+
+        {
+            ensiie::ScopedTimer timer(frame_timer(FramePhase::PRESENT));
+            window_->present();
+        }
     }
 
     void SDLApp::process_menu_events(SDL_Event& event) {
@@ -553,6 +676,12 @@ namespace sdl {
                     sim_type_ = SimType::PLATE_2D;
                     n_ = 101;
                     break;
+                case SDLK_b:
+                    cycle_method_2d();
+                    break;
+                case SDLK_c:
+                    cycle_palette();
+                    break;
                 case SDLK_RETURN:
                 case SDLK_SPACE:
                     start_simulation();
@@ -575,14 +704,10 @@ namespace sdl {
 
             int speed_btn_y = panel_y_ + 240;
             if (is_in_rect(mx, my, px, speed_btn_y, half_btn, 28)) {
-                speed_ = std::max(1, speed_ - (sim_type_ == SimType::BAR_1D ? 5 : 2));
+                change_speed(-1);
             }
             if (is_in_rect(mx, my, px + half_btn + 10, speed_btn_y, half_btn, 28)) {
-                if (sim_type_ == SimType::BAR_1D) {
-                    speed_ = std::min(50, speed_ + 5);
-                } else {
-                    speed_ = std::min(20, speed_ + 2);
-                }
+                change_speed(1);
             }
 
             int play_pause_y = panel_y_ + 443;
@@ -590,12 +715,10 @@ namespace sdl {
             int menu_y = panel_y_ + 533;
 
             if (is_in_rect(mx, my, px, play_pause_y, btn_w, 35)) {
-                paused_ = !paused_;
+                set_paused(!paused_);
             }
             if (is_in_rect(mx, my, px, reset_y, btn_w, 35)) {
-                if (solver_1d_) solver_1d_->reset();
-                if (solver_2d_) solver_2d_->reset();
-                paused_ = false;
+                reset_simulation();
             }
             if (is_in_rect(mx, my, px, menu_y, btn_w, 35)) {
                 stop_simulation();
@@ -610,83 +733,104 @@ namespace sdl {
                 case SDLK_m:
                     stop_simulation();
                     break;
+                case SDLK_c:
+                    cycle_palette();
+                    break;
                 case SDLK_SPACE:
-                    paused_ = !paused_;
+                    set_paused(!paused_);
                     break;
                 case SDLK_r:
-                    if (solver_1d_) solver_1d_->reset();
-                    if (solver_2d_) solver_2d_->reset();
-                    paused_ = false;
+                    reset_simulation();
+                    break;
+                case SDLK_p:
+                    set_profiling(!profiling_);
                     break;
                 case SDLK_UP:
-                    if (sim_type_ == SimType::BAR_1D) {
-                        speed_ = std::min(50, speed_ + 5);
-                    } else {
-                        speed_ = std::min(20, speed_ + 2);
-                    }
+                    change_speed(1);
                     break;
                 case SDLK_DOWN:
-                    speed_ = std::max(1, speed_ - (sim_type_ == SimType::BAR_1D ? 5 : 2));
+                    change_speed(-1);
                     break;
                 case SDLK_PLUS:
                 case SDLK_EQUALS:
                 case SDLK_KP_PLUS:
                     tmax_ = std::min(120.0, tmax_ + 5.0);
+                    if (simulation_) simulation_->send(SimulationCommand::Type::SET_TMAX, tmax_);
                     break;
                 case SDLK_MINUS:
                 case SDLK_KP_MINUS:
                     tmax_ = std::max(5.0, tmax_ - 5.0);
+                    if (simulation_) simulation_->send(SimulationCommand::Type::SET_TMAX, tmax_);
                     break;
             }
         }
     }
 
     void SDLApp::run() {
+        // HEAT_TRACE=file.json records a timeline of the UI and solver threads
+        const char* trace_path = std::getenv("HEAT_TRACE");
+        if (trace_path && *trace_path) {
+            ensiie::Tracer::instance().start(trace_path);
+        }
+        ensiie::Tracer::instance().set_thread_name("ui");
+
         while (running_) {
-            SDL_Event event;
-            while (SDL_PollEvent(&event)) {
-                if (event.type == SDL_QUIT) {
-                    running_ = false;
-                }
-                if (event.type == SDL_WINDOWEVENT) {
-                    if (event.window.event == SDL_WINDOWEVENT_CLOSE) {
+            ensiie::TraceSpan frame_span("frame", "ui");
+            {
+                ensiie::ScopedTimer timer(frame_timer(FramePhase::EVENTS));
+
+                SDL_Event event;
+                while (SDL_PollEvent(&event)) {
+                    if (event.type == SDL_QUIT) {
                         running_ = false;
                     }
-                }
+                    if (event.type == SDL_WINDOWEVENT) {
+                        if (event.window.event == SDL_WINDOWEVENT_CLOSE) {
+                            running_ = false;
+                        }
+                    }
 
-                if (mode_ == Mode::MENU) {
-                    process_menu_events(event);
-                } else {
-                    process_simulation_events(event);
+                    if (mode_ == Mode::MENU) {
+                        process_menu_events(event);
+                    } else {
+                        process_simulation_events(event);
+                    }
                 }
-            }
 
-            if (!running_) break;
+                if (!running_) break;
 
-            if (mode_ == Mode::SIMULATION && !paused_) {
-                for (int i = 0; i < speed_; i++) {
-                    if (sim_type_ == SimType::BAR_1D && solver_1d_) {
-                        if (solver_1d_->get_time() >= tmax_ || !solver_1d_->step()) {
-                            paused_ = true;
-                            break;
-                        }
-                    } else if (sim_type_ == SimType::PLATE_2D && solver_2d_) {
-                        if (solver_2d_->get_time() >= tmax_ || !solver_2d_->step()) {
-                            paused_ = true;
-                            break;
-                        }
+                // Steps run on the solver thread, take its latest state. Once
+                // it has seen every command, it is the reference for pause
+                // (set when tmax is reached) and speed.
+                if (mode_ == Mode::SIMULATION && simulation_) {
+                    if (simulation_->poll() && simulation_->in_sync()) {
+                        paused_ = simulation_->snapshot().paused;
+                        speed_ = simulation_->snapshot().speed;
+                    }
+
+                    ensiie::StepRecord record;
+                    while (simulation_->pop_record(record)) {
+                        profile_overlay_.add_step(record);
                     }
                 }
             }
 
+            // Frames are paced by VSYNC, whatever the solver speed
             if (mode_ == Mode::MENU) {
                 render_menu();
             } else {
                 render_simulation();
             }
 
-            SDLCore::delay(16);
+            if (profiling_ && mode_ == Mode::SIMULATION) {
+                profile_overlay_.add_frame(frame_);
+            }
+            frame_ = FrameRecord{};
         }
+
+        // The solver thread hands its last events over when it exits
+        simulation_.reset();
+        ensiie::Tracer::instance().stop();
     }
 
 }
@@ -5,6 +5,8 @@
 #include "sdl_window.hpp"
 #include "sdl_font.hpp"
 #include "sdl_heatmap.hpp"
+#include "profile_overlay.hpp"
+#include "simulation_thread.hpp"
 #include "material.hpp"
 #include "heat_equation_solver_1d.hpp"
 #include "heat_equation_solver_2d.hpp"
@@ -30,8 +32,7 @@ namespace sdl {
             std::unique_ptr<SDLFont> button_font_;
             std::unique_ptr<SDLFont> small_font_;
 
-            std::unique_ptr<ensiie::HeatEquationSolver1D> solver_1d_;
-            std::unique_ptr<ensiie::HeatEquationSolver2D> solver_2d_;
+            std::unique_ptr<SimulationThread> simulation_;
 
             Mode mode_;
             SimType sim_type_;
@@ -39,6 +40,7 @@ namespace sdl {
             int selected_sim_type_;
             int selected_material_;
             int dragging_slider_;
+            ensiie::HeatEquationSolver2D::Method method_2d_;
 
             double L_;
             double tmax_;
@@ -50,6 +52,15 @@ namespace sdl {
             int speed_;
             bool running_;
 
+            bool profiling_;                    ///< Profiler overlay shown, steps and frames timed
+            ProfileOverlay profile_overlay_;    ///< Recent steps and frames
+            FrameRecord frame_;                 ///< Phases of the frame being drawn
+
+            /**
+             * @brief Get the counter of a frame phase, null when not profiling
+             */
+            double* frame_timer(FramePhase phase) { return profiling_ ? &frame_.at(phase) : nullptr; }
+
             void draw_rect(
                 int x
                 , int y
@@ -91,8 +102,30 @@ namespace sdl {
 
             void handle_slider_drag(int mx, int slider_idx, int slider_x, int slider_w);
 
+            /**
+             * @brief Largest grid size offered by the grid slider
+             */
+            int grid_max() const;
+
+            /**
+             * @brief Select the next 2D solver method
+             */
+            void cycle_method_2d();
+
+            /**
+             * @brief Select the next heatmap palette
+             */
+            void cycle_palette();
+
             void render_menu();
             void render_simulation();
+
+            /**
+             * @brief Draw the bar or plate of a snapshot, with its markers and statistics
+             * @param vis_w Width of the field area
+             * @param h Window height
+             */
+            void render_field(const SimulationSnapshot& snap, int vis_w, int h);
             void render_sim_control_panel(int x, int y, int w, int h, double current_time);
 
             void process_menu_events(SDL_Event& event);
@@ -106,6 +139,27 @@ namespace sdl {
             void start_simulation();
             void stop_simulation();
 
+            /**
+             * @brief Pause or resume the solver thread
+             */
+            void set_paused(bool paused);
+
+            /**
+             * @brief Change the steps per frame, clamped to the simulation's range
+             * @param delta Signed number of speed increments
+             */
+            void change_speed(int delta);
+
+            /**
+             * @brief Reset the simulation and resume
+             */
+            void reset_simulation();
+
+            /**
+             * @brief Show the profiler overlay and time steps and frames, or stop
+             */
+            void set_profiling(bool enabled);
+
         public:
             SDLApp();
 
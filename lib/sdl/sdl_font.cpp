@@ -1,11 +1,16 @@
 #include "sdl_font.hpp"
 #include "sdl_core.hpp"
+#include <algorithm>
 
 namespace sdl {
 
     SDLFont::SDLFont(const std::string& path, int size)
         : font_(nullptr)
-        , size_(size) {
+        , size_(size)
+        , renderer_(nullptr)
+        , atlas_(nullptr)
+        , glyphs_()
+        , line_height_(0) {
         font_ = TTF_OpenFont(path.c_str(), size);
         if (!font_) {
             throw TTFException("Failed to load font: " + path);
@@ -13,6 +18,7 @@ namespace sdl {
     }
 
     SDLFont::~SDLFont() {
+        release_textures();
         if (font_) {
             TTF_CloseFont(font_);
             font_ = nullptr;
@@ -21,41 +27,227 @@ namespace sdl {
 
     SDLFont::SDLFont(SDLFont&& other) noexcept
         : font_(other.font_)
-        , size_(other.size_) {
+        , size_(other.size_)
+        , renderer_(other.renderer_)
+        , atlas_(other.atlas_)
+        , glyphs_(other.glyphs_)
+        , line_height_(other.line_height_)
+        , cache_(std::move(other.cache_))
+        , index_(std::move(other.index_)) {
         other.font_ = nullptr;
+        other.renderer_ = nullptr;
+        other.atlas_ = nullptr;
+        other.cache_.clear();
+        other.index_.clear();
     }
 
     SDLFont& SDLFont::operator=(SDLFont&& other) noexcept {
         if (this != &other) {
+            release_textures();
             if (font_) {
                 TTF_CloseFont(font_);
             }
             font_ = other.font_;
             size_ = other.size_;
+            renderer_ = other.renderer_;
+            atlas_ = other.atlas_;
+            glyphs_ = other.glyphs_;
+            line_height_ = other.line_height_;
+            cache_ = std::move(other.cache_);
+            index_ = std::move(other.index_);
             other.font_ = nullptr;
+            other.renderer_ = nullptr;
+            other.atlas_ = nullptr;
+            other.cache_.clear();
+            other.index_.clear();
         }
         return *this;
     }
 
-    void SDLFont::render(
+    void SDLFont::release_textures() {
+        if (atlas_) {
+            SDL_DestroyTexture(atlas_);
+            atlas_ = nullptr;
+        }
+        for (CachedText& entry : cache_) {
+            if (entry.texture) {
+                SDL_DestroyTexture(entry.texture);
+            }
+        }
+        cache_.clear();
+        index_.clear();
+    }
+
+    void SDLFont::build_atlas() {
+        const int columns = 16;
+        const SDL_Color white = {255, 255, 255, 255};
+
+        line_height_ = TTF_FontHeight(font_);
+
+        // Each glyph as laid out by TTF_RenderText, so the cell width is its advance
+        std::array<SDL_Surface*, GLYPH_COUNT> surfaces{};
+        int cell_w = 1;
+        for (int k = 0; k < GLYPH_COUNT; k++) {
+            char text[2] = {static_cast<char>(FIRST_GLYPH + k), '\0'};
+            surfaces[k] = TTF_RenderText_Blended(font_, text, white);
+            if (surfaces[k]) {
+                cell_w = std::max(cell_w, surfaces[k]->w);
+            }
+        }
+
+        int rows = (GLYPH_COUNT + columns - 1) / columns;
+        SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(
+            0, columns * cell_w, rows * line_height_, 32, SDL_PIXELFORMAT_ARGB8888);
+
+        for (int k = 0; k < GLYPH_COUNT; k++) {
+            SDL_Surface* glyph = surfaces[k];
+            Glyph& cell = glyphs_[k];
+            cell.src = {(k % columns) * cell_w, (k / columns) * line_height_, 0, 0};
+            cell.advance = 0;
+
+            if (!glyph) {
+                continue;
+            }
+            cell.src.w = glyph->w;
+            cell.src.h = std::min(glyph->h, line_height_);
+            cell.advance = glyph->w;
+
+            if (atlas) {
+                // Copy the coverage as is, without blending on the empty atlas
+                SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+                SDL_Rect dst = cell.src;
+                SDL_BlitSurface(glyph, nullptr, atlas, &dst);
+            }
+            SDL_FreeSurface(glyph);
+        }
+
+        if (atlas) {
+            atlas_ = SDL_CreateTextureFromSurface(renderer_, atlas);
+            if (atlas_) {
+                SDL_SetTextureBlendMode(atlas_, SDL_BLENDMODE_BLEND);
+            }
+            SDL_FreeSurface(atlas);
+        }
+    }
+
+    bool SDLFont::in_atlas(const std::string& text) const {
+        for (char c : text) {
+            if (c < FIRST_GLYPH || c >= FIRST_GLYPH + GLYPH_COUNT) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int SDLFont::atlas_width(const std::string& text) const {
+        int width = 0;
+        for (std::size_t k = 0; k < text.size(); k++) {
+            if (k > 0) {
+                width += TTF_GetFontKerningSizeGlyphs(font_, static_cast<Uint16>(text[k - 1]), static_cast<Uint16>(text[k]));
+            }
+            width += glyphs_[text[k] - FIRST_GLYPH].advance;
+        }
+        return width;
+    }
+
+    void SDLFont::draw_atlas(const std::string& text, int x, int y, SDL_Color color) {
+        SDL_SetTextureColorMod(atlas_, color.r, color.g, color.b);
+        SDL_SetTextureAlphaMod(atlas_, color.a);
+
+        int pen = x;
+        for (std::size_t k = 0; k < text.size(); k++) {
+            if (k > 0) {
+                pen += TTF_GetFontKerningSizeGlyphs(font_, static_cast<Uint16>(text[k - 1]), static_cast<Uint16>(text[k]));
+            }
+            const Glyph& glyph = glyphs_[text[k] - FIRST_GLYPH];
+            if (text[k] != ' ') {
+                SDL_Rect dst = {pen, y, glyph.src.w, glyph.src.h};
+                SDL_RenderCopy(renderer_, atlas_, &glyph.src, &dst);
+            }
+            pen += glyph.advance;
+        }
+    }
+
+    SDLFont::CachedText& SDLFont::lookup(const std::string& text, SDL_Color color) {
+        std::string key = text;
+        key.push_back(static_cast<char>(color.r));
+        key.push_back(static_cast<char>(color.g));
+        key.push_back(static_cast<char>(color.b));
+        key.push_back(static_cast<char>(color.a));
+
+        auto found = index_.find(key);
+        if (found != index_.end()) {
+            cache_.splice(cache_.begin(), cache_, found->second);
+            return cache_.front();
+        }
+
+        if (cache_.size() >= CACHE_SIZE) {
+            CachedText& oldest = cache_.back();
+            if (oldest.texture) {
+                SDL_DestroyTexture(oldest.texture);
+            }
+            index_.erase(oldest.key);
+            cache_.pop_back();
+        }
+
+        cache_.push_front(CachedText{key, nullptr, 0, 0, 0});
+        index_[key] = cache_.begin();
+        return cache_.front();
+    }
+
+    void SDLFont::draw(
         SDL_Renderer* renderer
         , const std::string& text
         , int x
         , int y
+        , int w
+        , int h
         , SDL_Color color
+        , bool centered
     ) {
         if (!font_ || text.empty()) return;
 
-        SDL_Surface* surface = TTF_RenderText_Blended(font_, text.c_str(), color);
-        if (!surface) return;
+        if (renderer != renderer_) {
+            release_textures();
+            renderer_ = renderer;
+            build_atlas();
+        }
 
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-        if (texture) {
-            SDL_Rect dst = {x, y, surface->w, surface->h};
-            SDL_RenderCopy(renderer, texture, nullptr, &dst);
-            SDL_DestroyTexture(texture);
+        CachedText& entry = lookup(text, color);
+        entry.uses++;
+
+        // Strings seen twice, or not drawable from the atlas, get a texture
+        bool atlas_ok = atlas_ && in_atlas(text);
+        if (!entry.texture && (entry.uses >= 2 || !atlas_ok)) {
+            SDL_Surface* surface = TTF_RenderText_Blended(font_, text.c_str(), color);
+            if (surface) {
+                entry.texture = SDL_CreateTextureFromSurface(renderer_, surface);
+                entry.w = surface->w;
+                entry.h = surface->h;
+                SDL_FreeSurface(surface);
+            }
+        }
+
+        if (entry.texture) {
+            int tx = centered ? x + (w - entry.w) / 2 : x;
+            int ty = centered ? y + (h - entry.h) / 2 : y;
+            SDL_Rect dst = {tx, ty, entry.w, entry.h};
+            SDL_RenderCopy(renderer_, entry.texture, nullptr, &dst);
+        } else if (atlas_ok) {
+            int tx = centered ? x + (w - atlas_width(text)) / 2 : x;
+            int ty = centered ? y + (h - line_height_) / 2 : y;
+            draw_atlas(text, tx, ty, color);
         }
-        SDL_FreeSurface(surface);
+    }
+
+    void SDLFont::render(
+        SDL_Renderer* renderer
+        , const std::string& text
+        , int x
+        , int y
+        , SDL_Color color
+    ) {
+        draw(renderer, text, x, y, 0, 0, color, false);
     }
 
     void SDLFont::render_centered(
@@ -67,23 +259,7 @@ namespace sdl {
         , int h
         , SDL_Color color
     ) {
-        if (!font_ || text.empty()) return;
-
-        SDL_Surface* surface = TTF_RenderText_Blended(font_, text.c_str(), color);
-        if (!surface) return;
-
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-        if (texture) {
-            SDL_Rect dst = {
-                x + (w - surface->w) / 2,
-                y + (h - surface->h) / 2,
-                surface->w,
-                surface->h
-            };
-            SDL_RenderCopy(renderer, texture, nullptr, &dst);
-            SDL_DestroyTexture(texture);
-        }
-        SDL_FreeSurface(surface);
+        draw(renderer, text, x, y, w, h, color, true);
     }
 
     void SDLFont::get_text_size(const std::string& text, int* w, int* h) {
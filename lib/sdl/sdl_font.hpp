@@ -3,20 +3,102 @@
 
 #include <SDL.h>
 #include <SDL_ttf.h>
+#include <array>
+#include <list>
 #include <string>
 #include <memory>
+#include <unordered_map>
 
 namespace sdl {
 
     /**
      * @class SDLFont
      * @brief RAII wrapper for TTF_Font with text rendering utilities
+     *
+     * Text is drawn without rasterizing it every frame:
+     * - printable ASCII is rendered once into a glyph atlas, and a new
+     *   string costs one atlas copy per glyph, tinted with its color;
+     * - strings drawn again get their own texture, in an LRU cache keyed
+     *   by (text, color), and cost one copy. Numbers that change every
+     *   frame stay on the atlas, and only push out older one-off strings
+     *   while the labels drawn every frame stay most recent.
+     * Textures belong to the last renderer passed to render().
      */
     class SDLFont {
         private:
+            static constexpr char FIRST_GLYPH = ' ';            ///< First atlas character
+            static constexpr int GLYPH_COUNT = '~' - ' ' + 1;   ///< Printable ASCII
+            static constexpr std::size_t CACHE_SIZE = 128;      ///< Cached string textures
+
+            /// Glyph cell in the atlas
+            struct Glyph {
+                SDL_Rect src;       ///< Cell in the atlas texture
+                int advance;        ///< Pen advance after the glyph
+            };
+
+            /// Rendered string, texture created on its second use
+            struct CachedText {
+                std::string key;    ///< Text followed by the color bytes
+                SDL_Texture* texture;
+                int w;
+                int h;
+                int uses;
+            };
+
             TTF_Font* font_;
             int size_;
 
+            SDL_Renderer* renderer_;                ///< Owner of the textures below
+            SDL_Texture* atlas_;                    ///< White glyphs, tinted per draw
+            std::array<Glyph, GLYPH_COUNT> glyphs_;
+            int line_height_;
+            std::list<CachedText> cache_;           ///< Most recently used first
+            std::unordered_map<std::string, std::list<CachedText>::iterator> index_;
+
+            /**
+             * @brief Destroy the atlas and cached textures
+             */
+            void release_textures();
+
+            /**
+             * @brief Render the printable ASCII glyphs into the atlas
+             */
+            void build_atlas();
+
+            /**
+             * @brief Check that every character of text is in the atlas
+             */
+            bool in_atlas(const std::string& text) const;
+
+            /**
+             * @brief Width of text laid out from the atlas, with kerning
+             */
+            int atlas_width(const std::string& text) const;
+
+            /**
+             * @brief Draw text glyph by glyph from the atlas
+             */
+            void draw_atlas(const std::string& text, int x, int y, SDL_Color color);
+
+            /**
+             * @brief Find or insert the cache entry of (text, color), as most recent
+             */
+            CachedText& lookup(const std::string& text, SDL_Color color);
+
+            /**
+             * @brief Draw text at (x, y), or centered in the w x h box
+             */
+            void draw(
+                SDL_Renderer* renderer
+                , const std::string& text
+                , int x
+                , int y
+                , int w
+                , int h
+                , SDL_Color color
+                , bool centered
+            );
+
         public:
             SDLFont(const std::string& path, int size);
             ~SDLFont();
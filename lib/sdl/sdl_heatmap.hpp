@@ -3,7 +3,9 @@
 
 #include "sdl_window.hpp"
 #include "sdl_font.hpp"
-#include <vector>
+#include "colormap.hpp"
+#include "field_stats.hpp"
+#include "field_view.hpp"
 #include <memory>
 
 namespace sdl {
@@ -14,23 +16,70 @@ namespace sdl {
      */
     class SDLHeatmap {
         private:
+            /// Streaming texture with one pixel per grid point
+            struct GridTexture {
+                SDL_Texture* texture;
+                int width;
+                int height;
+            };
+
             SDLWindow& win_;
             double t_min_;
             double t_max_;
             std::unique_ptr<SDLFont> font_;
             std::unique_ptr<SDLFont> label_font_;
+            Colormap colormap_;
+            GridTexture bar_texture_;
+            GridTexture plate_texture_;
 
             void temp_to_rgb(double t, Uint8& r, Uint8& g, Uint8& b) const;
 
+            /**
+             * @brief Create the texture, or recreate it when the grid size changes
+             *
+             * The renderer scales it with linear filtering, which replaces
+             * the per-cell interpolation and rectangles.
+             * @throws SDLException if the texture cannot be created
+             */
+            void ensure_texture(GridTexture& grid, int width, int height);
+
+            /**
+             * @brief Lock the texture and get its pixels, 0xAARRGGBB each
+             * @param pitch Bytes per texture row
+             * @throws SDLException if the texture cannot be locked
+             */
+            Uint32* lock_texture(GridTexture& grid, int& pitch);
+
         public:
             SDLHeatmap(SDLWindow& win, double t_min, double t_max);
+            ~SDLHeatmap();
+
+            SDLHeatmap(const SDLHeatmap&) = delete;
+            SDLHeatmap& operator=(const SDLHeatmap&) = delete;
 
             void set_range(double t_min, double t_max);
-            void auto_range(const std::vector<double>& temps);
-            void auto_range_2d(const std::vector<std::vector<double>>& temps);
+
+            /**
+             * @brief Select the color palette
+             */
+            void set_palette(Palette palette) { colormap_.set_palette(palette); }
+
+            /**
+             * @brief Get the color palette
+             */
+            Palette get_palette() const { return colormap_.get_palette(); }
+
+            /**
+             * @brief Fit the color range to the extremes computed by the solver
+             *
+             * Ranges and statistics come from the solver's FieldStats, the
+             * methods taking a FieldView read the field in place, a bar
+             * being a single row, so a frame neither copies nor scans it.
+             */
+            void auto_range(const ensiie::FieldStats& stats);
 
             void draw_bar_1d(
-                const std::vector<double>& temps
+                ensiie::FieldView temps
                 , int x
                 , int y
                 , int width
@@ -38,7 +87,7 @@ namespace sdl {
             );
 
             void draw_plate_2d(
-                const std::vector<std::vector<double>>& temps
+                ensiie::FieldView temps
                 , int x
                 , int y
                 , int size
@@ -69,13 +118,7 @@ namespace sdl {
             );
 
             void draw_stats(
-                const std::vector<double>& temps
-                , int x
-                , int y
-            );
-
-            void draw_stats_2d(
-                const std::vector<std::vector<double>>& temps
+                const ensiie::FieldStats& stats
                 , int x
                 , int y
             );
@@ -94,7 +137,7 @@ namespace sdl {
             );
 
             void draw_heat_flow_1d(
-                const std::vector<double>& temps
+                ensiie::FieldView temps
                 , int x
                 , int y
                 , int width
@@ -102,7 +145,7 @@ namespace sdl {
             );
 
             void draw_heat_flow_2d(
-                const std::vector<std::vector<double>>& temps
+                ensiie::FieldView temps
                 , int x
                 , int y
                 , int size
@@ -1,5 +1,6 @@
 #include "sdl_window.hpp"
 #include "sdl_core.hpp"
+#include "trace.hpp"
 
 namespace sdl
 {
@@ -11,6 +12,7 @@ namespace sdl
     )
     : window_(nullptr)
     , renderer_(nullptr)
+    , surface_(nullptr)
     , width_(width)
     , height_(height)
     , fullscreen_(fullscreen)
@@ -47,9 +49,30 @@ namespace sdl
         }
     }
 
+    SDLWindow::SDLWindow(int width, int height)
+    : window_(nullptr)
+    , renderer_(nullptr)
+    , surface_(nullptr)
+    , width_(width)
+    , height_(height)
+    , fullscreen_(false)
+    {
+        surface_ = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!surface_) {
+            throw SDLException("SDL_CreateRGBSurfaceWithFormat failed");
+        }
+
+        renderer_ = SDL_CreateSoftwareRenderer(surface_);
+        if (!renderer_) {
+            SDL_FreeSurface(surface_);
+            throw SDLException("SDL_CreateSoftwareRenderer failed");
+        }
+    }
+
     SDLWindow::~SDLWindow() {
         if (renderer_) SDL_DestroyRenderer(renderer_);
         if (window_) SDL_DestroyWindow(window_);
+        if (surface_) SDL_FreeSurface(surface_);
     }
 
     void SDLWindow::clear(Uint8 r, Uint8 g, Uint8 b) {
@@ -58,14 +81,17 @@ namespace sdl
     }
 
     void SDLWindow::present() {
+        ensiie::TraceSpan span("present", "render");
         SDL_RenderPresent(renderer_);
     }
 
     void SDLWindow::set_title(const std::string& title) {
+        if (!window_) return;
         SDL_SetWindowTitle(window_, title.c_str());
     }
 
     void SDLWindow::toggle_fullscreen() {
+        if (!window_) return;
         fullscreen_ = !fullscreen_;
         if (fullscreen_) {
             SDL_SetWindowFullscreen(window_, SDL_WINDOW_FULLSCREEN);
@@ -14,6 +14,7 @@ namespace sdl {
         private:
             SDL_Window* window_;
             SDL_Renderer* renderer_;
+            SDL_Surface* surface_;      ///< Offscreen target, null for a window
             int width_;
             int height_;
             bool fullscreen_;
@@ -32,6 +33,17 @@ namespace sdl {
                 , int height
                 , bool fullscreen = false
             );
+
+            /**
+             * @brief Construct an offscreen target, without window or display
+             *
+             * Draws into a surface with the software renderer, e.g. to time
+             * the drawing code on a headless machine. set_title() and
+             * toggle_fullscreen() do nothing.
+             * @param width Surface width
+             * @param height Surface height
+             */
+            SDLWindow(int width, int height);
             ~SDLWindow();
 
             SDLWindow(const SDLWindow&) = delete;
@@ -57,6 +69,12 @@ namespace sdl {
             SDL_Window* get_window() const { return window_; }
 
             SDL_Renderer* get_renderer() const { return renderer_; }
+
+            /**
+             * @brief Get the pixels of an offscreen target, null for a window
+             */
+            SDL_Surface* get_surface() const { return surface_; }
+
             int get_width() const { return width_; }
             int get_height() const { return height_; }
 
@@ -0,0 +1,208 @@
+#include "simulation_thread.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace sdl {
+
+    namespace {
+        /// Interval between two batches of speed steps, one 60 Hz frame
+        const std::chrono::milliseconds STEP_INTERVAL(16);
+
+        /// Polling interval for commands while paused
+        const std::chrono::milliseconds IDLE_INTERVAL(2);
+    }
+
+    SimulationThread::SimulationThread(std::unique_ptr<ensiie::HeatEquationSolver1D> solver, int speed, double tmax)
+        : solver_1d_(std::move(solver))
+        , solver_2d_(nullptr)
+        , commands_sent_(0)
+        , quit_(false)
+        , failed_(false)
+        , paused_(false)
+        , speed_(speed)
+        , tmax_(tmax)
+        , profiling_(false)
+        , commands_applied_(0) {
+        publish();
+        thread_ = std::thread(&SimulationThread::run, this);
+    }
+
+    SimulationThread::SimulationThread(std::unique_ptr<ensiie::HeatEquationSolver2D> solver, int speed, double tmax)
+        : solver_1d_(nullptr)
+        , solver_2d_(std::move(solver))
+        , commands_sent_(0)
+        , quit_(false)
+        , failed_(false)
+        , paused_(false)
+        , speed_(speed)
+        , tmax_(tmax)
+        , profiling_(false)
+        , commands_applied_(0) {
+        publish();
+        thread_ = std::thread(&SimulationThread::run, this);
+    }
+
+    SimulationThread::~SimulationThread() {
+        quit_.store(true, std::memory_order_release);
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    bool SimulationThread::send(SimulationCommand::Type type, double value) {
+        if (!commands_.push(SimulationCommand{type, value})) {
+            return false;
+        }
+        commands_sent_++;
+        return true;
+    }
+
+    bool SimulationThread::poll() {
+        if (failed_.load(std::memory_order_acquire)) {
+            std::rethrow_exception(error_);
+        }
+        if (!snapshots_.update()) {
+            return false;
+        }
+        ensiie::Tracer::instant("snapshot", "ui", {{"time", snapshots_.front().time}});
+        return true;
+    }
+
+    bool SimulationThread::apply_commands() {
+        bool applied = false;
+        SimulationCommand command;
+
+        while (commands_.pop(command)) {
+            switch (command.type) {
+                case SimulationCommand::Type::SET_PAUSED:
+                    paused_ = (command.value != 0.0);
+                    break;
+                case SimulationCommand::Type::SET_SPEED:
+                    speed_ = static_cast<int>(command.value);
+                    break;
+                case SimulationCommand::Type::SET_TMAX:
+                    tmax_ = command.value;
+                    break;
+                case SimulationCommand::Type::SET_PROFILING:
+                    set_profiling(command.value != 0.0);
+                    break;
+                case SimulationCommand::Type::RESET:
+                    if (solver_1d_) solver_1d_->reset();
+                    if (solver_2d_) solver_2d_->reset();
+                    paused_ = false;
+                    break;
+            }
+            commands_applied_++;
+            applied = true;
+        }
+
+        return applied;
+    }
+
+    void SimulationThread::set_profiling(bool enabled) {
+        profiling_ = enabled;
+        if (solver_1d_) solver_1d_->set_profiling(enabled);
+        if (solver_2d_) solver_2d_->set_profiling(enabled);
+    }
+
+    void SimulationThread::advance() {
+        ensiie::TraceSpan span("advance", "solver");
+        span.arg("speed", speed_);
+
+        // Steps up to tmax, fewer than asked once it is reached
+        auto steps = [&](int count) {
+            return solver_1d_ ? solver_1d_->advance(count, tmax_) : solver_2d_->advance(count, tmax_);
+        };
+
+        if (!profiling_) {
+            // The whole batch in the solver, statistics of the last step only
+            if (steps(speed_) < speed_) {
+                paused_ = true;
+            }
+            return;
+        }
+
+        // One at a time, every profiled step is queued for the overlay
+        for (int i = 0; i < speed_; i++) {
+            if (steps(1) == 0) {
+                paused_ = true;
+                break;
+            }
+            records_.push(solver_1d_ ? solver_1d_->get_profile().last : solver_2d_->get_profile().last);
+        }
+    }
+
+    void SimulationThread::publish() {
+        ensiie::TraceSpan span("publish", "snapshot");
+        SimulationSnapshot& snap = snapshots_.back();
+
+        ensiie::FieldView field;
+        if (solver_1d_) {
+            field = solver_1d_->get_field();
+            snap.stats = solver_1d_->get_stats();
+            snap.time = solver_1d_->get_time();
+            snap.profile = solver_1d_->get_profile();
+        } else if (solver_2d_) {
+            field = solver_2d_->get_field();
+            snap.stats = solver_2d_->get_stats();
+            snap.time = solver_2d_->get_time();
+            snap.method = solver_2d_->get_method();
+            snap.last_step = solver_2d_->get_last_step();
+            snap.profile = solver_2d_->get_profile();
+        }
+
+        // Copy into the buffer's own storage, which keeps its capacity
+        // from one publish to the next
+        snap.temps.resize(field.size());
+        for (int j = 0; j < field.ny; j++) {
+            std::copy(field.row(j), field.row(j) + field.nx, snap.temps.begin() + j * field.nx);
+        }
+        snap.nx = field.nx;
+        snap.ny = field.ny;
+        snap.paused = paused_;
+        snap.speed = speed_;
+        snap.commands = commands_applied_;
+
+        snapshots_.publish();
+    }
+
+    void SimulationThread::run() {
+        using clock = std::chrono::steady_clock;
+
+        ensiie::Tracer::instance().set_thread_name("solver");
+        try {
+            clock::time_point next = clock::now();
+
+            while (!quit_.load(std::memory_order_acquire)) {
+                bool changed = apply_commands();
+
+                if (paused_) {
+                    if (changed) {
+                        publish();
+                    }
+                    std::this_thread::sleep_for(IDLE_INTERVAL);
+                    next = clock::now();
+                    continue;
+                }
+
+                advance();
+                publish();
+
+                // Keep the pace of speed steps per frame, or run the next
+                // batch at once when behind
+                next += STEP_INTERVAL;
+                clock::time_point now = clock::now();
+                if (next > now) {
+                    std::this_thread::sleep_until(next);
+                } else {
+                    next = now;
+                }
+            }
+        } catch (...) {
+            error_ = std::current_exception();
+            failed_.store(true, std::memory_order_release);
+        }
+    }
+
+}
@@ -0,0 +1,179 @@
+#ifndef SIMULATION_THREAD_HPP
+#define SIMULATION_THREAD_HPP
+
+#include "command_queue.hpp"
+#include "triple_buffer.hpp"
+#include "field_stats.hpp"
+#include "field_view.hpp"
+#include "heat_equation_solver_1d.hpp"
+#include "heat_equation_solver_2d.hpp"
+#include "step_profile.hpp"
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace sdl {
+
+    /**
+     * @struct SimulationSnapshot
+     * @brief State of a running simulation, published to the renderer
+     */
+    struct SimulationSnapshot {
+        std::vector<double> temps;                      ///< Temperatures (K), row-major, one row for a bar
+        int nx = 0;                                     ///< Points per row
+        int ny = 0;                                     ///< Number of rows, 1 for a bar
+        ensiie::FieldStats stats;                       ///< Statistics computed by the solver
+        double time = 0.0;                              ///< Simulation time (s)
+        ensiie::HeatEquationSolver2D::Method method = ensiie::HeatEquationSolver2D::Method::GAUSS_SEIDEL; ///< Plate solver method
+        ensiie::HeatEquationSolver2D::StepInfo last_step = {0, 0.0}; ///< Plate convergence of the last step
+        ensiie::StepProfile profile;                    ///< Step timings, while profiling
+        bool paused = false;                            ///< Stepping is paused, or tmax is reached
+        int speed = 0;                                  ///< Steps per frame interval
+        std::uint64_t commands = 0;                     ///< Number of commands applied before the snapshot
+
+        /**
+         * @brief View the temperatures, valid while the snapshot is held
+         */
+        ensiie::FieldView field() const { return ensiie::FieldView(temps, nx, ny); }
+    };
+
+    /**
+     * @struct SimulationCommand
+     * @brief Request sent from the UI to the solver thread
+     */
+    struct SimulationCommand {
+        enum class Type {
+            SET_PAUSED,     ///< value != 0 pauses
+            SET_SPEED,      ///< value is the number of steps per frame interval
+            SET_TMAX,       ///< value is the time at which stepping stops
+            SET_PROFILING,  ///< value != 0 times every step
+            RESET           ///< Back to the initial state and running
+        };
+
+        Type type;
+        double value;
+    };
+
+    /**
+     * @class SimulationThread
+     * @brief Run a solver on its own thread, decoupled from rendering
+     *
+     * The thread does `speed` steps per frame interval, or as many batches
+     * as it can when steps are slower, and publishes a snapshot after each
+     * batch through a triple buffer. The UI sends commands through a
+     * wait-free queue and reads the latest snapshot, so a slow step never
+     * blocks a frame and a fast solver never waits for the renderer.
+     */
+    class SimulationThread {
+        private:
+            std::unique_ptr<ensiie::HeatEquationSolver1D> solver_1d_;
+            std::unique_ptr<ensiie::HeatEquationSolver2D> solver_2d_;
+
+            TripleBuffer<SimulationSnapshot> snapshots_;
+            CommandQueue<SimulationCommand, 64> commands_;
+            CommandQueue<ensiie::StepRecord, 256> records_; ///< Profiled steps, dropped when full
+            std::uint64_t commands_sent_;       ///< UI side count of queued commands
+
+            std::atomic<bool> quit_;            ///< Set by the destructor
+            std::atomic<bool> failed_;          ///< The solver threw, see error_
+            std::exception_ptr error_;          ///< Written before failed_ is set
+
+            // Solver thread state
+            bool paused_;
+            int speed_;
+            double tmax_;
+            bool profiling_;
+            std::uint64_t commands_applied_;
+
+            std::thread thread_;                ///< Started last, joined first
+
+            /**
+             * @brief Thread body: apply commands, step, publish
+             */
+            void run();
+
+            /**
+             * @brief Apply all queued commands
+             * @return true if any was applied
+             */
+            bool apply_commands();
+
+            /**
+             * @brief Do one batch of speed_ steps, pause when tmax is reached
+             */
+            void advance();
+
+            /**
+             * @brief Copy the solver state into the back buffer and publish it
+             */
+            void publish();
+
+            /**
+             * @brief Set profiling on the solver
+             */
+            void set_profiling(bool enabled);
+
+        public:
+            /**
+             * @brief Start stepping a bar
+             * @param solver Solver, owned by the thread from now on
+             * @param speed Steps per frame interval
+             * @param tmax Time at which stepping stops
+             */
+            SimulationThread(std::unique_ptr<ensiie::HeatEquationSolver1D> solver, int speed, double tmax);
+
+            /**
+             * @brief Start stepping a plate
+             * @param solver Solver, owned by the thread from now on
+             * @param speed Steps per frame interval
+             * @param tmax Time at which stepping stops
+             */
+            SimulationThread(std::unique_ptr<ensiie::HeatEquationSolver2D> solver, int speed, double tmax);
+
+            /**
+             * @brief Stop and join the thread
+             */
+            ~SimulationThread();
+
+            SimulationThread(const SimulationThread&) = delete;
+            SimulationThread& operator=(const SimulationThread&) = delete;
+
+            /**
+             * @brief Queue a command for the solver thread (UI side)
+             * @return false if the queue is full and the command was dropped
+             */
+            bool send(SimulationCommand::Type type, double value = 0.0);
+
+            /**
+             * @brief Take the latest snapshot (UI side)
+             * @return true if snapshot() changed
+             * @throws The exception of a failed step, on the UI thread
+             */
+            bool poll();
+
+            /**
+             * @brief Take the oldest step profiled and not taken yet (UI side)
+             *
+             * Every profiled step is queued, not only those of a snapshot,
+             * up to 256 steps behind the UI; later ones are dropped.
+             * @return false if there is none
+             */
+            bool pop_record(ensiie::StepRecord& record) { return records_.pop(record); }
+
+            /**
+             * @brief Get the latest snapshot taken by poll()
+             */
+            const SimulationSnapshot& snapshot() const { return snapshots_.front(); }
+
+            /**
+             * @brief Check that snapshot() reflects every command sent
+             */
+            bool in_sync() const { return snapshot().commands == commands_sent_; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+
+namespace sdl {
+
+    /**
+     * @class TripleBuffer
+     * @brief Lock-free single producer, single consumer latest-value channel
+     *
+     * The producer fills its back buffer and publishes it, the consumer
+     * picks up the most recent published buffer. Each side owns one of the
+     * three buffers at any time and the third is swapped through one atomic
+     * index, so neither side ever waits for the other and intermediate
+     * values are simply overwritten.
+     */
+    template <class T>
+    class TripleBuffer {
+        private:
+            static constexpr int INDEX_MASK = 3;    ///< Buffer index bits of shared_
+            static constexpr int FRESH      = 4;    ///< Set when shared_ holds an unread value
+
+            std::array<T, 3> buffers_;
+            std::atomic<int> shared_;   ///< Buffer in the middle, with the FRESH bit
+            int back_;                  ///< Buffer owned by the producer
+            int front_;                 ///< Buffer owned by the consumer
+
+        public:
+            TripleBuffer()
+                : shared_(1)
+                , back_(0)
+                , front_(2) {
+            }
+
+            /**
+             * @brief Buffer the producer writes into (producer side)
+             */
+            T& back() { return buffers_[back_]; }
+
+            /**
+             * @brief Publish the back buffer and take a free one (producer side)
+             *
+             * The new back buffer holds an older value, so it must be
+             * rewritten before the next publish().
+             */
+            void publish() {
+                int previous = shared_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+                back_ = previous & INDEX_MASK;
+            }
+
+            /**
+             * @brief Take the latest published buffer, if any (consumer side)
+             * @return true if front() changed
+             */
+            bool update() {
+                if ((shared_.load(std::memory_order_relaxed) & FRESH) == 0) {
+                    return false;
+                }
+                int previous = shared_.exchange(front_, std::memory_order_acq_rel);
+                front_ = previous & INDEX_MASK;
+                return true;
+            }
+
+            /**
+             * @brief Buffer the consumer reads from (consumer side)
+             */
+            const T& front() const { return buffers_[front_]; }
+    };
+
+}
+
+#endif
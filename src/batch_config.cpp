@@ -0,0 +1,273 @@
+#include "batch_config.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+namespace batch {
+
+    namespace {
+        using Method = ensiie::HeatEquationSolver2D::Method;
+
+        std::string lowercase(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            return s;
+        }
+
+        std::string trim(const std::string& s) {
+            const char* blank = " \t\r\n";
+            std::size_t first = s.find_first_not_of(blank);
+            if (first == std::string::npos) {
+                return "";
+            }
+            return s.substr(first, s.find_last_not_of(blank) - first + 1);
+        }
+
+        double to_double(const std::string& key, const std::string& value) {
+            std::size_t used = 0;
+            double v = 0.0;
+            try {
+                v = std::stod(value, &used);
+            } catch (const std::exception&) {
+                used = 0;
+            }
+            if (used == 0 || used != value.size()) {
+                throw std::invalid_argument(key + ": expected a number, got '" + value + "'");
+            }
+            return v;
+        }
+
+        int to_int(const std::string& key, const std::string& value) {
+            double v = to_double(key, value);
+            if (v != static_cast<int>(v)) {
+                throw std::invalid_argument(key + ": expected an integer, got '" + value + "'");
+            }
+            return static_cast<int>(v);
+        }
+    }
+
+    const ensiie::Material& find_material(const std::string& name) {
+        std::string key = lowercase(name);
+        if (key == "copper")      return ensiie::Materials::COPPER;
+        if (key == "iron")        return ensiie::Materials::IRON;
+        if (key == "glass")       return ensiie::Materials::GLASS;
+        if (key == "polystyrene") return ensiie::Materials::POLYSTYRENE;
+        throw std::invalid_argument("unknown material '" + name + "'");
+    }
+
+    Method parse_method(const std::string& name) {
+        std::string key = lowercase(name);
+        if (key == "gauss-seidel" || key == "gs") return Method::GAUSS_SEIDEL;
+        if (key == "multigrid" || key == "mg")    return Method::MULTIGRID;
+        if (key == "sor")                         return Method::RED_BLACK_SOR;
+        if (key == "adi")                         return Method::ADI;
+        if (key == "spectral")                    return Method::SPECTRAL;
+        if (key == "pcg" || key == "cg")          return Method::CONJUGATE_GRADIENT;
+        if (key == "cholesky")                    return Method::CHOLESKY;
+        throw std::invalid_argument("unknown method '" + name + "'");
+    }
+
+    void set_parameter(RunConfig& config, const std::string& key, const std::string& value) {
+        if (key == "material") {
+            find_material(value);
+            config.material = lowercase(value);
+        } else if (key == "L") {
+            config.L = to_double(key, value);
+        } else if (key == "tmax") {
+            config.tmax = to_double(key, value);
+        } else if (key == "u0") {
+            config.u0 = to_double(key, value);
+        } else if (key == "f") {
+            config.f = to_double(key, value);
+        } else if (key == "n") {
+            config.n = to_int(key, value);
+            if (config.n < 3) {
+                throw std::invalid_argument("n: at least 3 points are needed");
+            }
+        } else if (key == "dimension") {
+            config.dimension = to_int(key, value);
+            if (config.dimension != 1 && config.dimension != 2) {
+                throw std::invalid_argument("dimension: expected 1 or 2");
+            }
+        } else if (key == "method") {
+            config.method = parse_method(value);
+        } else if (key == "threads") {
+            config.threads = to_int(key, value);
+        } else if (key == "steady") {
+            config.steady = to_double(key, value);
+            if (config.steady < 0.0) {
+                throw std::invalid_argument("steady: expected a tolerance >= 0");
+            }
+        } else if (key == "equilibrium") {
+            int flag = to_int(key, value);
+            if (flag != 0 && flag != 1) {
+                throw std::invalid_argument("equilibrium: expected 0 or 1");
+            }
+            config.equilibrium = (flag == 1);
+        } else if (key == "adaptive") {
+            config.adaptive = to_double(key, value);
+            if (config.adaptive < 0.0) {
+                throw std::invalid_argument("adaptive: expected a tolerance >= 0");
+            }
+        } else if (key == "output") {
+            config.output = value;
+        } else if (key == "field") {
+            config.field_output = value;
+        } else {
+            throw std::invalid_argument("unknown parameter '" + key + "'");
+        }
+    }
+
+    void set_sweep_parameter(SweepSpec& spec, const std::string& key, const std::string& value) {
+        if (key == "jobs") {
+            spec.jobs = to_int(key, value);
+            return;
+        }
+        if (key == "ensemble") {
+            spec.ensemble = to_int(key, value);
+            if (spec.ensemble < 1) {
+                throw std::invalid_argument("ensemble: expected at least 1 bar");
+            }
+            return;
+        }
+        if (key == "trace") {
+            spec.trace = value;
+            return;
+        }
+
+        // A later setting of the key replaces its axis
+        spec.axes.erase(std::remove_if(spec.axes.begin(), spec.axes.end()
+            , [&](const SweepAxis& axis) { return axis.key == key; }), spec.axes.end());
+
+        if (value.find(',') == std::string::npos) {
+            set_parameter(spec.base, key, value);
+            return;
+        }
+        if (key == "output" || key == "field") {
+            throw std::invalid_argument(key + ": cannot be swept");
+        }
+
+        SweepAxis axis{key, {}};
+        std::size_t start = 0;
+        while (start <= value.size()) {
+            std::size_t comma = std::min(value.find(',', start), value.size());
+            std::string item = trim(value.substr(start, comma - start));
+            RunConfig check = spec.base;
+            set_parameter(check, key, item);
+            axis.values.push_back(item);
+            start = comma + 1;
+        }
+        spec.axes.push_back(axis);
+    }
+
+    void load_config_file(SweepSpec& spec, const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("cannot read config file '" + path + "'");
+        }
+
+        std::string line;
+        int number = 0;
+        while (std::getline(in, line)) {
+            number++;
+            line = trim(line.substr(0, line.find('#')));
+            if (line.empty()) {
+                continue;
+            }
+            std::size_t eq = line.find('=');
+            if (eq == std::string::npos) {
+                throw std::invalid_argument(path + ":" + std::to_string(number) + ": expected key = value");
+            }
+            try {
+                set_sweep_parameter(spec, trim(line.substr(0, eq)), trim(line.substr(eq + 1)));
+            } catch (const std::invalid_argument& e) {
+                throw std::invalid_argument(path + ":" + std::to_string(number) + ": " + e.what());
+            }
+        }
+    }
+
+    SweepSpec parse_arguments(const std::vector<std::string>& args) {
+        SweepSpec spec;
+
+        for (std::size_t i = 0; i < args.size(); i++) {
+            const std::string& arg = args[i];
+            if (arg.compare(0, 2, "--") != 0) {
+                throw std::invalid_argument("unexpected argument '" + arg + "'");
+            }
+
+            std::string key = arg.substr(2);
+            std::string value;
+            std::size_t eq = key.find('=');
+            if (eq != std::string::npos) {
+                value = key.substr(eq + 1);
+                key = key.substr(0, eq);
+            } else if (i + 1 < args.size()) {
+                value = args[++i];
+            } else {
+                throw std::invalid_argument("missing value for --" + key);
+            }
+
+            if (key == "config") {
+                load_config_file(spec, value);
+            } else {
+                set_sweep_parameter(spec, key, value);
+            }
+        }
+
+        return spec;
+    }
+
+    std::vector<RunConfig> expand(const SweepSpec& spec) {
+        std::vector<RunConfig> configs = {spec.base};
+
+        for (const SweepAxis& axis : spec.axes) {
+            std::vector<RunConfig> next;
+            next.reserve(configs.size() * axis.values.size());
+            for (const RunConfig& config : configs) {
+                for (const std::string& value : axis.values) {
+                    next.push_back(config);
+                    set_parameter(next.back(), axis.key, value);
+                }
+            }
+            configs.swap(next);
+        }
+
+        return configs;
+    }
+
+    const char* usage() {
+        return
+            "Usage: heat_batch [--key value | --key=value | --config file]...\n"
+            "\n"
+            "  --material   copper, iron, glass or polystyrene (copper)\n"
+            "  --L          length of the bar or side of the plate in m (1)\n"
+            "  --tmax       simulated time in s (16)\n"
+            "  --u0         initial temperature in C (13)\n"
+            "  --f          heat source amplitude in C (80)\n"
+            "  --n          points per dimension (1001 for 1D, 101 for 2D)\n"
+            "  --dimension  1 for a bar, 2 for a plate (1)\n"
+            "  --method     2D backend: gauss-seidel, multigrid, sor, adi,\n"
+            "               spectral, pcg or cholesky (gauss-seidel)\n"
+            "  --threads    worker threads of a plate or a long bar, 0 for all\n"
+            "               cores (0)\n"
+            "  --adaptive   local error tolerance in K of adaptive steps,\n"
+            "               0 for tmax/1000 steps (0)\n"
+            "  --steady     stop once max |du/dt| is below this in K/s, 0 to run\n"
+            "               to tmax (0)\n"
+            "  --equilibrium  1 to solve for the equilibrium directly (0)\n"
+            "  --output     result file, one JSON object per run (stdout)\n"
+            "  --field      CSV file of the final temperatures in C\n"
+            "  --config     file of key = value lines, # for comments\n"
+            "  --jobs       sweep workers, 0 for all cores (0)\n"
+            "  --ensemble   most bars of a sweep stepped together in SIMD lanes,\n"
+            "               1 to step each alone (64)\n"
+            "  --trace      Chrome trace file of the steps and runs (none)\n"
+            "\n"
+            "Later settings override earlier ones. A comma separated list, such as\n"
+            "--material copper,iron --n 101,201, sweeps every combination and\n"
+            "writes one JSON line per run as it completes.\n";
+    }
+
+}
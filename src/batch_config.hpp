@@ -0,0 +1,118 @@
+#ifndef BATCH_CONFIG_HPP
+#define BATCH_CONFIG_HPP
+
+#include "heat_equation_solver_2d.hpp"
+#include "material.hpp"
+#include <string>
+#include <vector>
+
+namespace batch {
+
+    /**
+     * @struct RunConfig
+     * @brief Parameters of one headless run
+     */
+    struct RunConfig {
+        std::string material = "copper";    ///< copper, iron, glass or polystyrene
+        double L = 1.0;                     ///< Length of the bar or side of the plate (m)
+        double tmax = 16.0;                 ///< Simulated time (s)
+        double u0 = 13.0;                   ///< Initial temperature (Celsius)
+        double f = 80.0;                    ///< Heat source amplitude (Celsius)
+        int n = 0;                          ///< Points per dimension, 0 for 1001 (1D) or 101 (2D)
+        int dimension = 1;                  ///< 1 for a bar, 2 for a plate
+        ensiie::HeatEquationSolver2D::Method method = ensiie::HeatEquationSolver2D::Method::GAUSS_SEIDEL; ///< 2D backend
+        int threads = 0;                    ///< Worker threads of a plate or a long bar, 0 for hardware concurrency
+        double adaptive = 0.0;              ///< Local error tolerance of adaptive steps (K), 0 for fixed steps
+        double steady = 0.0;                ///< Stop once the rate of change is below this (K/s), 0 to run to tmax
+        bool equilibrium = false;           ///< Solve for the equilibrium directly instead of stepping
+        std::string output;                 ///< Result file, empty for stdout
+        std::string field_output;           ///< CSV file of the final field, empty for none
+
+        /**
+         * @brief Get n, or its default for the dimension
+         */
+        int points() const { return n > 0 ? n : (dimension == 2 ? 101 : 1001); }
+    };
+
+    /**
+     * @struct SweepAxis
+     * @brief Parameter taking several values in a sweep
+     */
+    struct SweepAxis {
+        std::string key;                    ///< Parameter name
+        std::vector<std::string> values;    ///< Values, each valid for set_parameter()
+    };
+
+    /**
+     * @struct SweepSpec
+     * @brief Base configuration and the axes of its parameter grid
+     *
+     * A spec without axes is a single run.
+     */
+    struct SweepSpec {
+        RunConfig base;                     ///< Parameters shared by every run
+        std::vector<SweepAxis> axes;        ///< Swept parameters, in declaration order
+        int jobs = 0;                       ///< Sweep workers, 0 for hardware concurrency
+        int ensemble = 64;                  ///< Most bars of a sweep stepped together, 1 for none
+        std::string trace;                  ///< Chrome trace file of the process, empty for none
+    };
+
+    /**
+     * @brief Set one parameter from its text form
+     * @param key Parameter name, as in RunConfig (method for the 2D backend)
+     * @throws std::invalid_argument on an unknown key or a malformed value
+     */
+    void set_parameter(RunConfig& config, const std::string& key, const std::string& value);
+
+    /**
+     * @brief Set a parameter of a spec, a comma separated list making it an axis
+     *
+     * `jobs` sets the number of sweep workers and `ensemble` the most bars
+     * stepped together. The file parameters (output, field) cannot be
+     * swept.
+     * @throws std::invalid_argument on an unknown key or a malformed value
+     */
+    void set_sweep_parameter(SweepSpec& spec, const std::string& key, const std::string& value);
+
+    /**
+     * @brief Apply a file of `key = value` lines, # starting a comment
+     * @throws std::runtime_error if the file cannot be read
+     * @throws std::invalid_argument on a malformed line, with its number
+     */
+    void load_config_file(SweepSpec& spec, const std::string& path);
+
+    /**
+     * @brief Build a spec from the command line
+     *
+     * Accepts `--key value`, `--key=value` and `--config file`, applied in
+     * order so that later settings override earlier ones. A value such as
+     * `--material copper,iron` sweeps the parameter.
+     * @throws std::invalid_argument on a malformed argument
+     */
+    SweepSpec parse_arguments(const std::vector<std::string>& args);
+
+    /**
+     * @brief Expand the parameter grid, the last axis varying fastest
+     */
+    std::vector<RunConfig> expand(const SweepSpec& spec);
+
+    /**
+     * @brief Find a predefined material by its English name, any case
+     * @throws std::invalid_argument if there is none
+     */
+    const ensiie::Material& find_material(const std::string& name);
+
+    /**
+     * @brief Parse a 2D backend name (gauss-seidel, multigrid, sor, adi, spectral, pcg, cholesky)
+     * @throws std::invalid_argument if there is none
+     */
+    ensiie::HeatEquationSolver2D::Method parse_method(const std::string& name);
+
+    /**
+     * @brief Get the command line help
+     */
+    const char* usage();
+
+}
+
+#endif
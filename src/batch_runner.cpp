@@ -0,0 +1,281 @@
+#include "batch_runner.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+/// Celsius to Kelvin conversion
+constexpr double KELVIN_OFFSET = 273.15;
+
+namespace batch {
+
+    namespace {
+        using clock = std::chrono::steady_clock;
+
+        double seconds_since(clock::time_point start) {
+            return std::chrono::duration<double>(clock::now() - start).count();
+        }
+
+        /**
+         * @brief Check whether steps of a 2D method iterate, their counts being reported
+         */
+        bool counts_iterations(ensiie::HeatEquationSolver2D::Method method) {
+            using Method = ensiie::HeatEquationSolver2D::Method;
+            return method == Method::GAUSS_SEIDEL || method == Method::MULTIGRID
+                || method == Method::RED_BLACK_SOR || method == Method::CONJUGATE_GRADIENT;
+        }
+
+        /// Quote and escape a string for JSON
+        std::string json_string(const std::string& text) {
+            std::string quoted = "\"";
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    quoted += '\\';
+                    quoted += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    quoted += ' ';
+                } else {
+                    quoted += c;
+                }
+            }
+            return quoted + "\"";
+        }
+
+        /// Parameters of a run, the opening fields of its JSON line
+        void write_parameters(std::ostream& line, const RunConfig& config) {
+            line << "{\"material\":" << json_string(config.material)
+                 << ",\"dimension\":" << config.dimension
+                 << ",\"method\":\"" << (config.dimension == 2 ? ensiie::to_string(config.method) : "Thomas") << "\""
+                 << ",\"L\":" << config.L
+                 << ",\"tmax\":" << config.tmax
+                 << ",\"u0\":" << config.u0
+                 << ",\"f\":" << config.f
+                 << ",\"n\":" << config.points()
+                 << ",\"adaptive\":" << config.adaptive
+                 << ",\"steady_tolerance\":" << config.steady
+                 << ",\"equilibrium\":" << (config.equilibrium ? "true" : "false");
+        }
+
+        void keep(RunResult& result, ensiie::FieldView view) {
+            result.nx = view.nx;
+            result.ny = view.ny;
+            result.field.resize(view.size());
+            for (int j = 0; j < view.ny; j++) {
+                std::copy(view.row(j), view.row(j) + view.nx, result.field.begin() + j * view.nx);
+            }
+        }
+    }
+
+    Run::Run(const RunConfig& config)
+        : config_(config)
+        , done_(false) {
+        ensiie::TraceSpan span("setup", "batch");
+        const ensiie::Material& mat = find_material(config.material);
+        const int n = config.points();
+
+        clock::time_point start = clock::now();
+        ensiie::AdaptiveOptions adaptive;
+        adaptive.tolerance = config.adaptive;
+        if (config.dimension == 1) {
+            solver_1d_ = std::make_unique<ensiie::HeatEquationSolver1D>(mat, config.L, config.tmax, config.u0, config.f, n);
+            solver_1d_->set_threads(config.threads);
+            if (config.adaptive > 0.0) {
+                solver_1d_->set_adaptive(true, adaptive);
+            }
+            if (config.steady > 0.0) {
+                solver_1d_->set_steady_stop(true, config.steady);
+            }
+        } else {
+            solver_2d_ = std::make_unique<ensiie::HeatEquationSolver2D>(mat, config.L, config.tmax, config.u0, config.f, n, config.method);
+            solver_2d_->set_threads(config.threads);
+            if (config.adaptive > 0.0) {
+                solver_2d_->set_adaptive(true, adaptive);
+            }
+            if (config.steady > 0.0) {
+                solver_2d_->set_steady_stop(true, config.steady);
+            }
+        }
+        result_.setup_seconds = seconds_since(start);
+    }
+
+    bool Run::advance(int steps) {
+        ensiie::TraceSpan span("advance", "batch");
+        span.arg("steps", steps);
+        clock::time_point start = clock::now();
+        if (config_.equilibrium && !done_) {
+            if (solver_1d_) {
+                solver_1d_->solve_steady();
+            } else {
+                solver_2d_->solve_steady();
+            }
+            done_ = true;
+        }
+        if (solver_1d_ || !counts_iterations(solver_2d_->get_method())) {
+            // Nothing to collect per step, the solver runs them back to back
+            if (!done_) {
+                int taken = solver_1d_ ? solver_1d_->advance(steps) : solver_2d_->advance(steps);
+                result_.steps += taken;
+                done_ = taken < steps;
+            }
+        } else {
+            for (int k = 0; k < steps && !done_; k++) {
+                done_ = !solver_2d_->step();
+                if (!done_) {
+                    int it = solver_2d_->get_last_step().iterations;
+                    result_.iterations += it;
+                    result_.max_iterations = std::max(result_.max_iterations, it);
+                    result_.steps++;
+                }
+            }
+        }
+        result_.solve_seconds += seconds_since(start);
+        return !done_;
+    }
+
+    RunResult Run::result(bool keep_field) const {
+        RunResult result = result_;
+        if (solver_1d_) {
+            result.time = solver_1d_->get_time();
+            result.stats = solver_1d_->get_stats();
+            result.rejected = solver_1d_->get_step_control().get_stats().rejected;
+            result.steady = solver_1d_->is_steady();
+            result.equilibrium_time = solver_1d_->get_steady_state().equilibrium_time;
+            if (keep_field) {
+                keep(result, solver_1d_->get_field());
+            }
+        } else {
+            result.time = solver_2d_->get_time();
+            result.stats = solver_2d_->get_stats();
+            result.rejected = solver_2d_->get_step_control().get_stats().rejected;
+            result.steady = solver_2d_->is_steady();
+            result.equilibrium_time = solver_2d_->get_steady_state().equilibrium_time;
+            if (keep_field) {
+                keep(result, solver_2d_->get_field());
+            }
+        }
+        return result;
+    }
+
+    long long Run::cells() const {
+        long long n = config_.points();
+        return config_.dimension == 2 ? n * n : n;
+    }
+
+    EnsembleRun::EnsembleRun(const std::vector<RunConfig>& configs)
+        : configs_(configs)
+        , solve_seconds_(0.0)
+        , steps_(0)
+        , done_(false) {
+        ensiie::TraceSpan span("setup", "batch");
+        span.arg("bars", static_cast<double>(configs.size()));
+        clock::time_point start = clock::now();
+        std::vector<ensiie::BarSpec> bars;
+        for (const RunConfig& config : configs_) {
+            bars.push_back({find_material(config.material), config.u0, config.f});
+        }
+        const RunConfig& grid = configs_.front();
+        ensemble_ = std::make_unique<ensiie::HeatEquationEnsemble1D>(bars, grid.L, grid.tmax, grid.points());
+        setup_seconds_ = seconds_since(start);
+    }
+
+    bool EnsembleRun::advance(int steps) {
+        ensiie::TraceSpan span("advance", "batch");
+        span.arg("steps", steps);
+        clock::time_point start = clock::now();
+        if (!done_) {
+            int taken = ensemble_->advance(steps);
+            steps_ += taken;
+            done_ = taken < steps;
+        }
+        solve_seconds_ += seconds_since(start);
+        return !done_;
+    }
+
+    RunResult EnsembleRun::result(int bar) const {
+        RunResult result;
+        result.steps = steps_;
+        result.equilibrium_time = ensemble_->get_steady_state(bar).equilibrium_time;
+        result.time = ensemble_->get_time();
+        result.setup_seconds = setup_seconds_ / ensemble_->size();
+        result.solve_seconds = solve_seconds_ / ensemble_->size();
+        result.stats = ensemble_->get_stats(bar);
+        return result;
+    }
+
+    long long EnsembleRun::cells() const {
+        return static_cast<long long>(configs_.front().points()) * ensemble_->size();
+    }
+
+    bool can_ensemble(const RunConfig& config) {
+        return config.dimension == 1 && config.adaptive == 0.0 && config.steady == 0.0 && !config.equilibrium;
+    }
+
+    RunResult run(const RunConfig& config, bool keep_field) {
+        Run job(config);
+        while (job.advance(std::numeric_limits<int>::max())) {
+        }
+        return job.result(keep_field);
+    }
+
+    void write_json(std::ostream& out, const RunConfig& config, const RunResult& result) {
+        const int n = config.points();
+        const double cells = (config.dimension == 2) ? static_cast<double>(n) * n : n;
+        const double ns_per_cell = (result.steps > 0)
+            ? result.solve_seconds * 1e9 / (cells * result.steps)
+            : 0.0;
+
+        std::ostringstream line;
+        line << std::setprecision(10);
+        write_parameters(line, config);
+        line << ",\"steps\":" << result.steps
+             << ",\"rejected\":" << result.rejected
+             << ",\"time\":" << result.time
+             << ",\"iterations\":" << result.iterations
+             << ",\"max_iterations\":" << result.max_iterations
+             << ",\"min_c\":" << result.stats.min - KELVIN_OFFSET
+             << ",\"max_c\":" << result.stats.max - KELVIN_OFFSET
+             << ",\"mean_c\":" << result.stats.mean - KELVIN_OFFSET
+             << ",\"energy\":" << result.stats.energy
+             << ",\"boundary_flux\":" << result.stats.boundary_flux
+             << ",\"last_delta\":" << result.stats.delta
+             << ",\"steady\":" << (result.steady ? "true" : "false")
+             << ",\"equilibrium_time\":";
+        if (std::isfinite(result.equilibrium_time)) {
+            line << result.equilibrium_time;
+        } else {
+            line << "null";
+        }
+        line << ",\"setup_s\":" << result.setup_seconds
+             << ",\"solve_s\":" << result.solve_seconds
+             << ",\"ns_per_cell_step\":" << ns_per_cell
+             << "}\n";
+
+        // Whole line at once, flushed, so a run is complete in the file or absent
+        out << line.str() << std::flush;
+    }
+
+    void write_error_json(std::ostream& out, const RunConfig& config, const std::string& message) {
+        std::ostringstream line;
+        line << std::setprecision(10);
+        write_parameters(line, config);
+        line << ",\"error\":" << json_string(message) << "}\n";
+        out << line.str() << std::flush;
+    }
+
+    void write_field_csv(std::ostream& out, const RunResult& result) {
+        out << std::setprecision(8);
+        for (int j = 0; j < result.ny; j++) {
+            for (int i = 0; i < result.nx; i++) {
+                if (i > 0) {
+                    out << ',';
+                }
+                out << result.field[j * result.nx + i] - KELVIN_OFFSET;
+            }
+            out << '\n';
+        }
+    }
+
+}
@@ -0,0 +1,149 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include "batch_config.hpp"
+#include "field_stats.hpp"
+#include "heat_equation_ensemble_1d.hpp"
+#include "heat_equation_solver_1d.hpp"
+#include "heat_equation_solver_2d.hpp"
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace batch {
+
+    /**
+     * @struct RunResult
+     * @brief Outcome and timing of one headless run
+     */
+    struct RunResult {
+        int steps = 0;                  ///< Time steps done, accepted ones when adaptive
+        long long rejected = 0;         ///< Adaptive steps redone with a smaller step
+        bool steady = false;            ///< The field reached its equilibrium
+        double equilibrium_time = 0.0;  ///< Estimated time to equilibrium (s), infinite if unknown
+        double time = 0.0;              ///< Simulated time reached (s)
+        double setup_seconds = 0.0;     ///< Wall time of the solver construction
+        double solve_seconds = 0.0;     ///< Wall time of the stepping loop
+        long long iterations = 0;       ///< Sum of the 2D iterations over all steps
+        int max_iterations = 0;         ///< Most 2D iterations in one step
+        ensiie::FieldStats stats;       ///< Statistics of the final field
+        std::vector<double> field;      ///< Final temperatures (K), row-major
+        int nx = 0;                     ///< Points per row
+        int ny = 0;                     ///< Number of rows, 1 for a bar
+    };
+
+    /**
+     * @class Run
+     * @brief One configuration being stepped, in as many slices as wanted
+     */
+    class Run {
+        private:
+            RunConfig config_;
+            std::unique_ptr<ensiie::HeatEquationSolver1D> solver_1d_;
+            std::unique_ptr<ensiie::HeatEquationSolver2D> solver_2d_;
+            RunResult result_;
+            bool done_;
+
+        public:
+            /**
+             * @brief Build the solver, timed as the setup
+             * @throws std::invalid_argument on an unknown material
+             */
+            explicit Run(const RunConfig& config);
+
+            /**
+             * @brief Do up to `steps` steps, timed as the solve
+             * @return false once tmax is reached
+             * @throws Whatever the solver throws, e.g. std::logic_error for an unsupported backend
+             */
+            bool advance(int steps);
+
+            /**
+             * @brief Get the result, with the statistics of the current field
+             * @param keep_field Copy the field into the result
+             */
+            RunResult result(bool keep_field) const;
+
+            /**
+             * @brief Get the number of grid points
+             */
+            long long cells() const;
+
+            const RunConfig& config() const { return config_; }
+    };
+
+    /**
+     * @class EnsembleRun
+     * @brief Bars of the same grid stepped together, one result per configuration
+     *
+     * Wall times are split evenly between the bars, so that their cost
+     * per cell and step compares with separate runs.
+     */
+    class EnsembleRun {
+        private:
+            std::vector<RunConfig> configs_;
+            std::unique_ptr<ensiie::HeatEquationEnsemble1D> ensemble_;
+            double setup_seconds_;
+            double solve_seconds_;
+            int steps_;
+            bool done_;
+
+        public:
+            /**
+             * @brief Build the ensemble, timed as the setup
+             * @param configs Runs for which can_ensemble() holds, of the same n, L and tmax
+             * @throws std::invalid_argument on an unknown material
+             */
+            explicit EnsembleRun(const std::vector<RunConfig>& configs);
+
+            /**
+             * @brief Do up to `steps` steps of every bar, timed as the solve
+             * @return false once tmax is reached
+             */
+            bool advance(int steps);
+
+            /**
+             * @brief Get the result of one bar, with the statistics of its current field
+             * @param bar Index of the configuration
+             */
+            RunResult result(int bar) const;
+
+            /**
+             * @brief Get the number of grid points of all bars
+             */
+            long long cells() const;
+
+            const std::vector<RunConfig>& configs() const { return configs_; }
+    };
+
+    /**
+     * @brief Check whether a run can be stepped in an ensemble: a bar at
+     * fixed steps to tmax, without steady stop or equilibrium solve
+     */
+    bool can_ensemble(const RunConfig& config);
+
+    /**
+     * @brief Build the solver and step it to tmax at full speed
+     * @param keep_field Copy the final field into the result
+     * @throws Whatever the solver throws, e.g. std::logic_error for an unsupported backend
+     */
+    RunResult run(const RunConfig& config, bool keep_field);
+
+    /**
+     * @brief Write a run as one line of JSON
+     */
+    void write_json(std::ostream& out, const RunConfig& config, const RunResult& result);
+
+    /**
+     * @brief Write a failed run as one line of JSON, with its parameters and the error
+     */
+    void write_error_json(std::ostream& out, const RunConfig& config, const std::string& message);
+
+    /**
+     * @brief Write the final field as CSV in Celsius, one line per row
+     */
+    void write_field_csv(std::ostream& out, const RunResult& result);
+
+}
+
+#endif
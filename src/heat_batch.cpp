@@ -0,0 +1,80 @@
+#include "batch_config.hpp"
+#include "batch_runner.hpp"
+#include "sweep.hpp"
+#include "trace.hpp"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * @brief Headless entry point: run one configuration, or a sweep, to tmax and report it
+ *
+ * Links the solver library only, so it runs on machines without a
+ * display server.
+ */
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (const std::string& arg : args) {
+        if (arg == "--help" || arg == "-h") {
+            std::cout << batch::usage();
+            return 0;
+        }
+    }
+
+    batch::SweepSpec spec;
+    std::vector<batch::RunConfig> configs;
+    try {
+        spec = batch::parse_arguments(args);
+        configs = batch::expand(spec);
+        if (configs.size() > 1 && !spec.base.field_output.empty()) {
+            throw std::invalid_argument("--field needs a single run");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "heat_batch: " << e.what() << "\n\n" << batch::usage();
+        return 2;
+    }
+
+    const batch::RunConfig& config = spec.base;
+    try {
+        if (!spec.trace.empty()) {
+            ensiie::Tracer::instance().start(spec.trace);
+            ensiie::Tracer::instance().set_thread_name("main");
+        }
+
+        std::ofstream file;
+        if (!config.output.empty()) {
+            file.open(config.output, std::ios::app);
+            if (!file) {
+                throw std::runtime_error("cannot write '" + config.output + "'");
+            }
+        }
+        std::ostream& out = config.output.empty() ? std::cout : file;
+
+        if (configs.size() > 1) {
+            batch::SweepSummary summary = batch::run_sweep(configs, spec.jobs, spec.ensemble, out);
+            std::cerr << "heat_batch: " << summary.runs << " runs, " << summary.failed << " failed, "
+                      << summary.seconds << " s\n";
+            ensiie::Tracer::instance().stop();
+            return summary.failed > 0 ? 1 : 0;
+        }
+
+        batch::RunResult result = batch::run(config, !config.field_output.empty());
+        batch::write_json(out, config, result);
+
+        if (!config.field_output.empty()) {
+            std::ofstream field(config.field_output);
+            if (!field) {
+                throw std::runtime_error("cannot write '" + config.field_output + "'");
+            }
+            batch::write_field_csv(field, result);
+        }
+    } catch (const std::exception& e) {
+        ensiie::Tracer::instance().stop();
+        std::cerr << "heat_batch: " << e.what() << "\n";
+        return 1;
+    }
+
+    ensiie::Tracer::instance().stop();
+
+    return 0;
+}
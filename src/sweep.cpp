@@ -0,0 +1,186 @@
+#include "sweep.hpp"
+#include "batch_runner.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace batch {
+
+    namespace {
+        /// Grid points times steps done by one slice, a few tens of ms
+        const long long SLICE_CELL_STEPS = 1LL << 24;
+
+        /// Live runs per worker
+        const int RUNS_PER_WORKER = 2;
+
+        /// Grid of the bars stepped together
+        using BarGrid = std::tuple<int, double, double>;
+
+        /**
+         * @brief Shared state of a sweep, referenced by every task
+         */
+        class Sweep {
+            private:
+                std::vector<std::vector<RunConfig>> units_; ///< Runs started together, by decreasing cost
+                std::atomic<std::size_t> next_;     ///< Next unit to start
+                ensiie::WorkStealingPool& pool_;
+
+                std::mutex out_mutex_;
+                std::ostream& out_;
+                int written_;                       ///< Under out_mutex_
+                int failed_;                        ///< Under out_mutex_
+
+                void write(const Run& run) {
+                    RunResult result = run.result(false);
+                    std::lock_guard<std::mutex> lock(out_mutex_);
+                    write_json(out_, run.config(), result);
+                    written_++;
+                }
+
+                void write(const EnsembleRun& run) {
+                    std::lock_guard<std::mutex> lock(out_mutex_);
+                    for (std::size_t bar = 0; bar < run.configs().size(); bar++) {
+                        write_json(out_, run.configs()[bar], run.result(static_cast<int>(bar)));
+                        written_++;
+                    }
+                }
+
+                void write_error(std::size_t unit, const char* message) {
+                    std::lock_guard<std::mutex> lock(out_mutex_);
+                    for (const RunConfig& config : units_[unit]) {
+                        write_error_json(out_, config, message);
+                        written_++;
+                        failed_++;
+                    }
+                }
+
+                /**
+                 * @brief Build the run of a unit, then step its first slice
+                 */
+                template<class Job, class Source>
+                void start(std::size_t unit, const Source& source) {
+                    std::shared_ptr<Job> job;
+                    try {
+                        job = std::make_shared<Job>(source);
+                    } catch (const std::exception& e) {
+                        write_error(unit, e.what());
+                        start_next();
+                        return;
+                    }
+                    slice(job, unit);
+                }
+
+                /**
+                 * @brief Step one slice, then queue the rest or start the next run
+                 */
+                template<class Job>
+                void slice(const std::shared_ptr<Job>& job, std::size_t unit) {
+                    int steps = static_cast<int>(std::max(1LL, SLICE_CELL_STEPS / job->cells()));
+                    bool more = false;
+                    try {
+                        more = job->advance(steps);
+                    } catch (const std::exception& e) {
+                        write_error(unit, e.what());
+                        start_next();
+                        return;
+                    }
+
+                    if (more) {
+                        pool_.defer([this, job, unit] { slice(job, unit); });
+                    } else {
+                        write(*job);
+                        start_next();
+                    }
+                }
+
+            public:
+                Sweep(const std::vector<RunConfig>& configs, int ensemble, ensiie::WorkStealingPool& pool, std::ostream& out)
+                    : next_(0)
+                    , pool_(pool)
+                    , out_(out)
+                    , written_(0)
+                    , failed_(0) {
+                    // Bars differing only in material, u0 and f share an ensemble
+                    std::map<BarGrid, std::vector<RunConfig>> bars;
+                    for (RunConfig config : configs) {
+                        if (config.threads == 0) {
+                            config.threads = 1;
+                        }
+                        if (ensemble > 1 && can_ensemble(config)) {
+                            bars[BarGrid(config.points(), config.L, config.tmax)].push_back(config);
+                        } else {
+                            units_.push_back({config});
+                        }
+                    }
+
+                    // As many ensembles as workers at least, of even sizes
+                    for (const auto& grid : bars) {
+                        const std::vector<RunConfig>& group = grid.second;
+                        std::size_t count = group.size();
+                        std::size_t most = static_cast<std::size_t>(ensemble);
+                        std::size_t parts = std::max((count + most - 1) / most
+                                                     , std::min(count, static_cast<std::size_t>(pool.size())));
+                        for (std::size_t p = 0; p < parts; p++) {
+                            units_.emplace_back(group.begin() + p * count / parts, group.begin() + (p + 1) * count / parts);
+                        }
+                    }
+
+                    // Longest processing time first, 1000 steps for every run
+                    auto cost = [](const std::vector<RunConfig>& unit) {
+                        long long n = unit.front().points();
+                        return (unit.front().dimension == 2 ? n * n : n) * static_cast<long long>(unit.size());
+                    };
+                    std::stable_sort(units_.begin(), units_.end()
+                        , [&](const std::vector<RunConfig>& a, const std::vector<RunConfig>& b) {
+                        return cost(a) > cost(b);
+                    });
+                }
+
+                /**
+                 * @brief Queue the next unit not started yet, if any
+                 */
+                void start_next() {
+                    std::size_t i = next_.fetch_add(1);
+                    if (i >= units_.size()) {
+                        return;
+                    }
+
+                    pool_.submit([this, i] {
+                        if (units_[i].size() > 1) {
+                            start<EnsembleRun>(i, units_[i]);
+                        } else {
+                            start<Run>(i, units_[i].front());
+                        }
+                    });
+                }
+
+                int written() const { return written_; }
+                int failed() const { return failed_; }
+        };
+    }
+
+    SweepSummary run_sweep(const std::vector<RunConfig>& configs, int jobs, int ensemble, std::ostream& out) {
+        auto start = std::chrono::steady_clock::now();
+
+        ensiie::WorkStealingPool pool(jobs);
+        Sweep sweep(configs, ensemble, pool, out);
+
+        // Each finished run starts the next one, which keeps this many live
+        for (int k = 0; k < RUNS_PER_WORKER * pool.size(); k++) {
+            sweep.start_next();
+        }
+        pool.wait();
+
+        SweepSummary summary;
+        summary.runs = sweep.written();
+        summary.failed = sweep.failed();
+        summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return summary;
+    }
+
+}
@@ -0,0 +1,42 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+#include "batch_config.hpp"
+#include <ostream>
+#include <vector>
+
+namespace batch {
+
+    /**
+     * @struct SweepSummary
+     * @brief Totals of a finished sweep
+     */
+    struct SweepSummary {
+        int runs = 0;               ///< Runs written, failed ones included
+        int failed = 0;             ///< Runs that threw, written as error lines
+        double seconds = 0.0;       ///< Wall time of the whole sweep
+    };
+
+    /**
+     * @brief Run independent configurations on a work-stealing pool
+     *
+     * Runs start from the most expensive one, so that the longest finish
+     * early. A run of more than one slice of work steps a slice at a time
+     * and queues the rest behind its worker's next task, where an idle
+     * worker takes it first: a large plate shares its worker with the
+     * runs started after it instead of holding them up. At most two runs
+     * per worker are live at a time, which bounds the memory. Runs left
+     * at `threads = 0` use one thread each, the parallelism being across
+     * runs. Bars of the same grid at fixed steps are stepped together in
+     * the SIMD lanes of an ensemble of up to `ensemble` bars, split so
+     * that every worker gets one.
+     * @param configs Runs, in any order
+     * @param jobs Number of workers, 0 for hardware concurrency
+     * @param ensemble Most bars of an ensemble, 1 to step each alone
+     * @param out Receives one JSON line per run as soon as it completes
+     */
+    SweepSummary run_sweep(const std::vector<RunConfig>& configs, int jobs, int ensemble, std::ostream& out);
+
+}
+
+#endif